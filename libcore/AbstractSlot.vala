@@ -103,6 +103,7 @@ public abstract class Files.AbstractSlot : GLib.Object {
 
     public abstract void initialize_directory ();
     public abstract unowned GLib.List<Files.File>? get_selected_files ();
+    public virtual unowned Files.SelectionSet? get_selection () { return null; }
     public abstract void set_active_state (bool set_active, bool animate = true);
     public abstract unowned AbstractSlot? get_current_slot ();
     public abstract void reload (bool non_local_only = false);
@@ -76,7 +76,6 @@ public class Files.Directory : Object {
     public signal void thumbs_loaded ();
     public signal void need_reload (bool original_request);
 
-    private uint idle_consume_changes_id = 0;
     private bool removed_from_cache;
     private bool monitor_blocked = false;
 
@@ -776,8 +775,27 @@ public class Files.Directory : Object {
         }
     }
 
+    /* Emits file_loaded for the files listed so far. Views that start showing a directory while it is loading, e.g.
+     * after it was prefetched, have missed the signals for these files. */
+    public void emit_loaded_files () {
+        if (state != State.LOADING) {
+            return;
+        }
+
+        bool show_hidden = get_show_hidden ();
+        foreach (unowned Files.File gof in file_hash.get_values ()) {
+            if (gof != null && is_shown (gof, show_hidden)) {
+                file_loaded (gof);
+            }
+        }
+    }
+
+    private bool is_shown (Files.File gof, bool show_hidden) {
+        return show_hidden || !(gof.is_hidden || gof.info.get_is_hidden ());
+    }
+
     private void after_load_file (Files.File gof, bool show_hidden, FileLoadedFunc? file_loaded_func) {
-        if (show_hidden || !(gof.is_hidden || gof.info.get_is_hidden ())) {
+        if (is_shown (gof, show_hidden)) {
             displayed_files_count++;
 
             if (file_loaded_func == null) {
@@ -917,9 +935,11 @@ public class Files.Directory : Object {
         }
     }
 
-    private void notify_file_added (Files.File gof, bool is_internal) {
+    /* Returns whether the file is counted as an item of the folder */
+    private bool notify_file_added (Files.File gof, bool is_internal) {
         // Do not delay adding file to model - use fallback is_hidden
-        if ((!gof.is_hidden || Preferences.get_default ().show_hidden_files)) {
+        var visible = !gof.is_hidden || Preferences.get_default ().show_hidden_files;
+        if (visible) {
             file_added (gof, is_internal);
         }
 
@@ -938,6 +958,8 @@ public class Files.Directory : Object {
                 }
             }
         });
+
+        return visible;
     }
 
     private void notify_file_changed (Files.File gof) {
@@ -946,10 +968,12 @@ public class Files.Directory : Object {
         });
     }
 
-    private void notify_file_removed (Files.File gof) {
+    /* Returns whether the file was counted as an item of the folder */
+    private bool notify_file_removed (Files.File gof) {
         this.file_hash.remove (gof.location);
 
-        if (!gof.is_hidden || Preferences.get_default ().show_hidden_files) {
+        var visible = !gof.is_hidden || Preferences.get_default ().show_hidden_files;
+        if (visible) {
             file_deleted (gof);
         }
 
@@ -966,27 +990,83 @@ public class Files.Directory : Object {
         }
 
         gof.remove_from_caches ();
+        return visible;
+    }
+
+    /* Whether a file existed before and after the events received for it while the view is frozen, and whether
+     * it was deleted and created again in between, e.g. by an atomic save.  Replaying the net change gives the
+     * same result as replaying every event once FileChanges has merged them.
+     */
+    [Compact]
+    private class FChanges {
+        public bool existed;
+        public bool exists;
+        public bool recreated = false;
+
+        public FChanges (FileMonitorEvent event) {
+            existed = event != FileMonitorEvent.CREATED;
+            exists = existed;
+            add (event);
+        }
+
+        public void add (FileMonitorEvent event) {
+            switch (event) {
+                case FileMonitorEvent.CREATED:
+                    recreated |= !exists && existed;
+                    exists = true;
+                    break;
+                case FileMonitorEvent.DELETED:
+                    exists = false;
+                    break;
+                default:
+                    break;
+            }
+        }
     }
 
-    private struct FChanges {
-        GLib.File file;
-        FileMonitorEvent event;
+    private HashTable<GLib.File, FChanges>? frozen_changes = null;
+    private bool frozen_needs_reload = false;
+    /* Changes to this many files are always replayed on thawing.  Beyond that the folder is reloaded
+     * instead if more than a quarter of its files have changed. */
+    private const uint FCHANGES_MIN = 20;
+    private const uint FCHANGES_RELOAD_DIVISOR = 4;
+
+    private uint get_max_frozen_changes () {
+        return uint.max (FCHANGES_MIN, file_hash.size () / FCHANGES_RELOAD_DIVISOR);
     }
-    private List <FChanges?> list_fchanges = null;
-    private uint list_fchanges_count = 0;
-    /* number of monitored changes to store after that simply reload the dir */
-    private const uint FCHANGES_MAX = 20;
 
     private void directory_changed (GLib.File _file, GLib.File? other_file, FileMonitorEvent event) {
         /* If view is frozen, store events for processing later */
         if (freeze_update) {
-            if (list_fchanges_count < FCHANGES_MAX) {
-                var fc = FChanges ();
-                fc.file = _file;
-                fc.event = event;
-                list_fchanges.prepend (fc);
-                list_fchanges_count++;
+            switch (event) {
+                case FileMonitorEvent.CREATED:
+                case FileMonitorEvent.DELETED:
+                case FileMonitorEvent.ATTRIBUTE_CHANGED:
+                case FileMonitorEvent.CHANGES_DONE_HINT:
+                    break;
+                default:
+                    return; // Ignored by real_directory_changed ()
+            }
+
+            if (frozen_needs_reload) {
+                return;
             }
+
+            if (frozen_changes == null) {
+                frozen_changes = new HashTable<GLib.File, FChanges> (GLib.File.hash, GLib.File.equal);
+            }
+
+            unowned var fc = frozen_changes.lookup (_file);
+            if (fc != null) {
+                fc.add (event);
+            } else if (frozen_changes.size () >= get_max_frozen_changes ()) {
+                /* Too many changes to be worth replaying */
+                frozen_needs_reload = true;
+                frozen_changes = null;
+            } else {
+                frozen_changes.insert (_file, new FChanges (event));
+            }
+
             return;
         } else {
             real_directory_changed (_file, other_file, event);
@@ -1027,18 +1107,7 @@ public class Files.Directory : Object {
             case FileMonitorEvent.CHANGED:
                 break;
         }
-
-        if (idle_consume_changes_id == 0) {
-            /* Insert delay to avoid race between gof.rename () finishing and consume changes -
-             * If consume changes called too soon can corrupt the view.
-             * TODO: Have Files.Directory.Directory control renaming.
-             */
-            idle_consume_changes_id = Timeout.add (10, () => {
-                Files.FileChanges.consume_changes (true);
-                idle_consume_changes_id = 0;
-                return GLib.Source.REMOVE;
-            });
-        }
+        // FileChanges merges the events and consumes them after a short delay
     }
 
     private bool _freeze_update;
@@ -1049,18 +1118,29 @@ public class Files.Directory : Object {
         set {
             _freeze_update = value;
             if (!value && can_load) {
-                if (list_fchanges_count >= FCHANGES_MAX) {
+                if (frozen_needs_reload) {
                     need_reload (true);
-                } else if (list_fchanges_count > 0) {
-                    list_fchanges.reverse ();
-                    foreach (var fchange in list_fchanges) {
-                        real_directory_changed (fchange.file, null, fchange.event);
-                    }
+                } else if (frozen_changes != null) {
+                    frozen_changes.foreach ((file, fchange) => {
+                        if (fchange.existed && fchange.exists) {
+                            if (fchange.recreated) {
+                                /* Merged by FileChanges into the file being replaced */
+                                real_directory_changed (file, null, FileMonitorEvent.DELETED);
+                                real_directory_changed (file, null, FileMonitorEvent.CREATED);
+                            } else {
+                                real_directory_changed (file, null, FileMonitorEvent.ATTRIBUTE_CHANGED);
+                            }
+                        } else if (fchange.existed) {
+                            real_directory_changed (file, null, FileMonitorEvent.DELETED);
+                        } else if (fchange.exists) {
+                            real_directory_changed (file, null, FileMonitorEvent.CREATED);
+                        } // Else the file was created and deleted again
+                    });
                 }
             }
 
-            list_fchanges_count = 0;
-            list_fchanges = null;
+            frozen_needs_reload = false;
+            frozen_changes = null;
         }
     }
 
@@ -1090,6 +1170,7 @@ public class Files.Directory : Object {
     public static void notify_changes_added (List<Files.FileChanges.Change> changes) {
         bool already_present = false;
         bool files_added = false;
+        int items_added = 0;
         Directory? first_dir = cache_lookup_parent (changes.data.from);
         if (first_dir != null) {
             foreach (unowned var change in changes) {
@@ -1101,7 +1182,9 @@ public class Files.Directory : Object {
                     Files.File gof = first_dir.file_cache_find_or_insert (change.from, out already_present, true);
                     if (!already_present) {
                         files_added = true;
-                        first_dir.notify_file_added (gof, change.is_internal);
+                        if (first_dir.notify_file_added (gof, change.is_internal)) {
+                            items_added++;
+                        }
                     } // Else ignore files already added from duplicate event or internally
                 } else {
                     critical ("Unexpected parent of newly created file");
@@ -1109,11 +1192,7 @@ public class Files.Directory : Object {
             }
 
             if (files_added) {
-                first_dir.file.ensure_size ();  // Can we just use file_cache size?
-                var parent = cache_lookup_parent (first_dir.file.location);
-                if (parent != null) {
-                    parent.file_changed (first_dir.file);
-                }
+                first_dir.update_item_count (items_added);
             }
         }
     }
@@ -1122,6 +1201,7 @@ public class Files.Directory : Object {
     public static void notify_files_added_internally (List<GLib.File> files) {
         bool already_present = false;
         bool files_added = false;
+        int items_added = 0;
         Directory? first_dir = cache_lookup_parent (files.data);
         if (first_dir != null) {
             foreach (unowned var loc in files) {
@@ -1129,16 +1209,14 @@ public class Files.Directory : Object {
                 Files.File gof = first_dir.file_cache_find_or_insert (loc, out already_present, true);
                 if (!already_present) {
                     files_added = true;
-                    first_dir.notify_file_added (gof, true);
+                    if (first_dir.notify_file_added (gof, true)) {
+                        items_added++;
+                    }
                 } // Else ignore files added via FileMonitor event
             }
 
             if (files_added) {
-                first_dir.file.ensure_size ();  // Can we just use file_cache size?
-                var parent = cache_lookup_parent (first_dir.file.location);
-                if (parent != null) {
-                    parent.file_changed (first_dir.file);
-                }
+                first_dir.update_item_count (items_added);
             }
         } else {
             Directory? parent_dir = null;
@@ -1148,8 +1226,7 @@ public class Files.Directory : Object {
                 var gof = parent_dir.file_hash.lookup (first_parent);
                 if (gof != null) {
                     // Files added to child folder item parent_dir
-                    gof.ensure_size ();
-                    parent_dir.file_changed (gof);
+                    queue_item_recount (gof);
                 }
             }
         }
@@ -1158,22 +1235,21 @@ public class Files.Directory : Object {
     // Can we assume all from same parent location??
     public static void notify_files_removed (List<GLib.File> files) {
         bool files_removed = false;
+        int items_removed = 0;
         Directory? first_dir = cache_lookup_parent (files.data);
         if (first_dir != null) {
             foreach (unowned var loc in files) {
                 Files.File? gof = first_dir.file_hash.lookup (loc);
                 if (gof != null) {
                     files_removed = true;
-                    first_dir.notify_file_removed (gof);
+                    if (first_dir.notify_file_removed (gof)) {
+                        items_removed++;
+                    }
                 }
             }
 
             if (files_removed) {
-                var parent = cache_lookup_parent (first_dir.file.location);
-                if (parent != null) {
-                    first_dir.file.ensure_size ();  // Can we just use file_cache size?
-                    parent.file_changed (first_dir.file);
-                }
+                first_dir.update_item_count (-items_removed);
             }
         } else {
             Directory? parent_dir = null;
@@ -1183,8 +1259,7 @@ public class Files.Directory : Object {
                 var gof = parent_dir.file_hash.lookup (first_parent);
                 if (gof != null) {
                     // Files removed from child folder item of parent_dir
-                    gof.ensure_size ();
-                    parent_dir.file_changed (gof);
+                    queue_item_recount (gof);
                 }
             } else {
                 foreach (unowned var loc in files) {
@@ -1214,6 +1289,52 @@ public class Files.Directory : Object {
         notify_files_added_internally (list_to);
     }
 
+    /* Keeps the item count of the folder up to date from the changes to its listing instead of enumerating it */
+    private void update_item_count (int delta) {
+        if (!file.adjust_item_count (delta)) {
+            queue_item_recount (file);
+            return;
+        }
+
+        var parent = cache_lookup_parent (file.location);
+        if (parent != null) {
+            parent.file_changed (file);
+        }
+    }
+
+    private static GLib.GenericSet<Files.File>? folders_to_recount = null;
+    private static uint recount_timeout_id = 0;
+    private const uint RECOUNT_DELAY_MSEC = 500;
+
+    /* Folders whose listing is not loaded are recounted on a worker thread, at most once per RECOUNT_DELAY_MSEC */
+    private static void queue_item_recount (Files.File folder) {
+        if (folders_to_recount == null) {
+            folders_to_recount = new GLib.GenericSet<Files.File> (direct_hash, direct_equal);
+        }
+
+        folders_to_recount.add (folder);
+        if (recount_timeout_id > 0) {
+            return;
+        }
+
+        recount_timeout_id = Timeout.add (RECOUNT_DELAY_MSEC, () => {
+            recount_timeout_id = 0;
+            var folders = (owned) folders_to_recount;
+            folders_to_recount = null;
+            folders.foreach ((to_recount) => {
+                to_recount.recount_items_async.begin ((obj, res) => {
+                    to_recount.recount_items_async.end (res);
+                    var parent = cache_lookup_parent (to_recount.location);
+                    if (parent != null) {
+                        parent.file_changed (to_recount);
+                    }
+                });
+            });
+
+            return GLib.Source.REMOVE;
+        });
+    }
+
     /* Files.Directory.directory_cache related functions */
     public static Directory? cache_lookup (GLib.File file) {
         // Cache may be null on startup. Static construct only runs when first
@@ -1263,11 +1384,16 @@ public class Files.Directory : Object {
                 directory_cache.remove (dir.creation_key);
 
                 dir.removed_from_cache = true;
-                return true;
+            } else {
+                return false;
             }
         }
 
-        return false;
+        if (plugins != null) {
+            plugins.forget_files_info (dir.location);
+        }
+
+        return true;
     }
 
     public static bool purge_dir_from_cache (Directory dir) {
@@ -1336,7 +1462,6 @@ public class Files.Directory : Object {
     }
 
     private void cancel_timeouts () {
-        cancel_timeout (ref idle_consume_changes_id);
         cancel_timeout (ref load_timeout_id);
         cancel_timeout (ref mount_timeout_id);
     }
@@ -0,0 +1,33 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* The model of the files shown by a directory view. ListModel supports expanding subfolders in the list view,
+ * FlatListModel only holds the files of one folder but scales to very large folders.
+ */
+public interface Files.DirectoryModel : Gtk.TreeModel, Gtk.TreeSortable {
+    public abstract bool show_hidden_files { get; set; }
+    public abstract bool is_empty { get; }
+    public abstract int icon_size { get; set; }
+    public abstract bool has_child { get; set; }
+    public abstract bool sort_pending { get; }
+
+    public abstract Files.File? file_for_path (Gtk.TreePath path);
+    public abstract Files.File? file_for_iter (Gtk.TreeIter iter);
+    public abstract uint get_length ();
+    public abstract Gtk.TreePath? get_path_for_first_file (Files.File? file);
+    /* Returns true if the file was not in the model and was added */
+    public abstract bool add_file (Files.File file, Files.Directory dir);
+    /* Adds the file then resorts the model, emitting rows-reordered */
+    public abstract bool insert_sorted (Files.File file, Files.Directory dir);
+    /* Returns true if the file was found and removed */
+    public abstract bool remove_file (Files.File file, Files.Directory dir);
+    public abstract void file_changed (Files.File file, Files.Directory dir);
+    public abstract void clear ();
+    // Turn off sorting while files are being added
+    public abstract void set_sorting_off ();
+    // Turn on sorting after model stops loading.
+    public abstract void set_sorting_on ();
+    public abstract void set_should_sort_directories_first (bool sort_directories_first);
+}
@@ -714,7 +714,8 @@ public class Files.File : GLib.Object {
     // This only changes the file icon if the request dimensions have changed.
     //TODO Rename function to reflect this
     // Does not compile if use pix_size and pix_scale as default values for some reason
-    public void update_icon (int _size = -1, int _scale = -1) {
+    // With @use_preview a preview rendered by PreviewEngine is shown if the file has no thumbnail
+    public void update_icon (int _size = -1, int _scale = -1, bool use_preview = false) {
         int requested_size = _size;
         int requested_scale = _scale;
         // Use existing values if dmensions unspecified
@@ -749,6 +750,21 @@ public class Files.File : GLib.Object {
                               thumbstate == ThumbState.READY) &&
                               pix_is_final;
 
+        if (use_preview && thumbstate == ThumbState.NONE && PreviewEngine.can_render_in_process (this)) {
+            var preview = PreviewEngine.get_default ().lookup (this, requested_size, requested_scale);
+            if (preview != null) {
+                if (pix != preview) {
+                    pix = preview;
+                    pix_size = requested_size;
+                    pix_scale = requested_scale;
+                    pix_is_final = true;
+                    after_icon_changed ();
+                }
+
+                return;
+            }
+        }
+
         if (pix != null && same_size && valid_thumbnail) {
             return;
         }
@@ -1199,10 +1215,44 @@ public class Files.File : GLib.Object {
 
     public void ensure_size () {
         ensure_item_count (true);
+        update_format_size ();
+    }
+
+    /* Adjusts the number of items in a folder by @delta without enumerating it again. Returns false if the
+     * count is unknown, in which case it must be recounted. */
+    public bool adjust_item_count (int delta) {
+        if (count < 0) {
+            return false;
+        }
+
+        count = int.max (0, count + delta);
+        update_format_size ();
+        return true;
+    }
+
+    /* Recounts the items in a folder on a worker thread */
+    public async void recount_items_async () {
+        if (!can_count_items ()) {
+            return;
+        }
+
+        var pref_show_hidden = Files.Preferences.get_default ().show_hidden_files;
+        var new_count = -1;
+        new GLib.Thread<bool> ("count-items", () => {
+            new_count = count_visible_items (location, pref_show_hidden);
+            GLib.Idle.add (recount_items_async.callback);
+            return true;
+        });
+
+        yield;
+
+        count = new_count;
+        update_format_size ();
+    }
+
+    private void update_format_size () {
         if (count >= 0) {
-            if (count < 0) {
-                format_size = "—";
-            } else if (count == 0) {
+            if (count == 0) {
                 format_size = _("Empty");
             } else {
                 format_size = ngettext ("%'d item", "%'d items", count).printf (count);
@@ -1214,36 +1264,41 @@ public class Files.File : GLib.Object {
         }
     }
 
-    private void ensure_item_count (bool recount) {
+    internal void ensure_item_count (bool recount) {
         if (count >= 0 && !recount) {
             return;
         }
 
-        var pref_show_hidden = Files.Preferences.get_default ().show_hidden_files;
-        if (location.has_uri_scheme ("file") ||
-            (is_mounted && location.is_native ())) {
+        if (can_count_items ()) {
+            count = count_visible_items (location, Files.Preferences.get_default ().show_hidden_files);
+        }
+    }
 
-            try {
-                var f_enum = location.enumerate_children (
-                    FileAttribute.STANDARD_IS_HIDDEN,
-                    FileQueryInfoFlags.NOFOLLOW_SYMLINKS,
-                    null
-                );
-                count = 0;
-                FileInfo info;
-                // Only count visible items
-                while ((info = f_enum.next_file ()) != null) {
-                    if (pref_show_hidden ||
-                        !info.get_attribute_boolean (FileAttribute.STANDARD_IS_HIDDEN)) {
-
-                        count++;
-                    }
+    private bool can_count_items () {
+        return location.has_uri_scheme ("file") || (is_mounted && location.is_native ());
+    }
+
+    /* Returns -1 if @location cannot be enumerated */
+    private static int count_visible_items (GLib.File location, bool show_hidden) {
+        int items = 0;
+        try {
+            var f_enum = location.enumerate_children (
+                FileAttribute.STANDARD_IS_HIDDEN,
+                FileQueryInfoFlags.NOFOLLOW_SYMLINKS,
+                null
+            );
+            FileInfo info;
+            // Only count visible items
+            while ((info = f_enum.next_file ()) != null) {
+                if (show_hidden || !info.get_attribute_boolean (FileAttribute.STANDARD_IS_HIDDEN)) {
+                    items++;
                 }
-            } catch (Error e) {
-                count = -1;
             }
+        } catch (Error e) {
+            return -1;
         }
 
+        return items;
     }
 
     private void update_formated_type () {
@@ -18,6 +18,11 @@
 
 namespace Files.FileChanges {
     const int CONSUME_CHANGES_MAX_CHUNK = 20;
+    /* Events arriving within this time are merged before being sent to the directories.  This also avoids a race
+     * between gof.rename () finishing and the changes being consumed, which can corrupt the view.
+     * TODO: Have Files.Directory.Directory control renaming.
+     */
+    const uint COALESCE_WINDOW_MSEC = 50;
 
     public enum Kind {
         INITIAL,
@@ -34,35 +39,215 @@ namespace Files.FileChanges {
         public GLib.File from;
         public GLib.File to;
         public bool is_internal;
+        public bool replaced; // Removed then added again since the last flush e.g. saved by replacing
     }
 
-    private static GLib.Queue<Change> queue;
+    /* The changes to the children of one folder since the last flush, merged so that there is at most one change
+     * per file.  Changes are sent to the directory as one batch of each kind, removals first.
+     */
+    public class Batch {
+        public GLib.File parent { get; private set; }
+        public uint raw_count { get; private set; default = 0; }
+        private GLib.HashTable<GLib.File, Change> changes;
+        private GLib.List<GLib.File> order; // Files in reverse order of their first change
+
+        public Batch (GLib.File parent) {
+            this.parent = parent;
+            changes = new GLib.HashTable<GLib.File, Change> (GLib.File.hash, GLib.File.equal);
+        }
+
+        public void add (owned Change change) {
+            raw_count++;
+            unowned var current = changes.lookup (change.from);
+            if (current == null) {
+                order.prepend (change.from);
+                changes.insert (change.from, (owned) change);
+                return;
+            }
+
+            switch (change.kind) {
+                case Kind.ADDED:
+                    if (is_removal (current.kind)) {
+                        current.kind = Kind.ADDED;
+                        current.replaced = true;
+                        current.is_internal = change.is_internal;
+                    } else if (current.kind == Kind.ADDED) {
+                        current.is_internal |= change.is_internal;
+                    } // Else the file is already known and changed
+
+                    break;
+                case Kind.CHANGED:
+                    // Added files are read anyway and removed files cannot change
+                    break;
+                case Kind.FILE_REMOVED:
+                case Kind.FOLDER_REMOVED:
+                    // Collapses a creation and deletion into a removal, which does nothing unless the file
+                    // was already added internally
+                    current.kind = change.kind;
+                    current.replaced = false;
+                    break;
+                default:
+                    GLib.assert_not_reached ();
+            }
+        }
+
+        /* The number of changes that will be sent */
+        public uint get_delivered_count () {
+            uint count = 0;
+            changes.foreach ((file, change) => {
+                count += change.replaced ? 2 : 1;
+            });
+
+            return count;
+        }
+
+        public Kind get_kind (GLib.File file) {
+            unowned var change = changes.lookup (file);
+            return change != null ? change.kind : Kind.INITIAL;
+        }
+
+        public bool is_replaced (GLib.File file) {
+            unowned var change = changes.lookup (file);
+            return change != null && change.replaced;
+        }
+
+        public bool is_internal (GLib.File file) {
+            unowned var change = changes.lookup (file);
+            return change != null && change.is_internal;
+        }
+
+        public void dispatch () {
+            GLib.List<GLib.File>? removals = null;
+            GLib.List<Change>? additions = null;
+            GLib.List<GLib.File>? changed = null;
+            /* Building the lists by prepending restores the order of arrival */
+            foreach (unowned var file in order) {
+                unowned var change = changes.lookup (file);
+                if (is_removal (change.kind) || change.replaced) {
+                    removals.prepend (file);
+                }
+
+                if (change.kind == Kind.ADDED) {
+                    additions.prepend (new Change () {
+                        kind = Kind.ADDED,
+                        from = file,
+                        is_internal = change.is_internal
+                    });
+                } else if (change.kind == Kind.CHANGED) {
+                    changed.prepend (file);
+                }
+            }
+
+            if (removals != null) {
+                Files.Directory.notify_files_removed (removals);
+            }
+
+            if (additions != null) {
+                Files.Directory.notify_changes_added (additions);
+            }
+
+            if (changed != null) {
+                Files.Directory.notify_files_changed (changed);
+            }
+        }
+
+        private static bool is_removal (Kind kind) {
+            return kind == Kind.FILE_REMOVED || kind == Kind.FOLDER_REMOVED;
+        }
+    }
+
+    /* A move, or the batch of changes queued in a folder before a move from or to it */
+    [Compact]
+    private class Step {
+        public Batch? batch;
+        public Change? move;
+    }
+
+    private static GLib.HashTable<GLib.File, Batch>? batches = null; // Keyed by parent folder
+    private static GLib.List<Step>? steps = null; // Most recent first
     private static GLib.Mutex queue_mutex;
+    private static uint flush_timeout_id = 0;
+    private static uint64 raw_events = 0;
+    private static uint64 delivered_events = 0;
+
+    /* Must be called with queue_mutex locked */
+    private static void schedule_flush () {
+        if (flush_timeout_id == 0) {
+            flush_timeout_id = GLib.Timeout.add (COALESCE_WINDOW_MSEC, () => {
+                queue_mutex.@lock ();
+                flush_timeout_id = 0;
+                queue_mutex.unlock ();
+                consume_changes (true);
+                return GLib.Source.REMOVE;
+            });
+        }
+    }
 
-    private static unowned GLib.Queue<Change> get_queue () {
+    private static void queue_add_common (owned Change new_item) {
         queue_mutex.@lock ();
-        if (queue == null) {
-            queue = new GLib.Queue<Change> ();
+        raw_events++;
+        if (new_item.kind == Kind.MOVED) {
+            queue_move ((owned) new_item);
+        } else {
+            add_to_batch ((owned) new_item);
         }
 
+        schedule_flush ();
         queue_mutex.unlock ();
+    }
 
-        return queue;
+    /* Must be called with queue_mutex locked */
+    private static void add_to_batch (owned Change change) {
+        if (batches == null) {
+            batches = new GLib.HashTable<GLib.File, Batch> (GLib.File.hash, GLib.File.equal);
+        }
+
+        var parent = change.from.get_parent () ?? change.from;
+        var batch = batches.lookup (parent);
+        if (batch == null) {
+            batch = new Batch (parent);
+            batches.insert (parent, batch);
+        }
+
+        batch.add ((owned) change);
     }
 
-    private static void queue_add_common (owned Change new_item) {
-        unowned GLib.Queue<Change> queue = get_queue ();
-        queue_mutex.@lock ();
-        unowned var last_item = queue.peek_head ();
-        // Ignore sequential duplicate events
-        if (last_item == null ||
-            !(last_item.from.equal (new_item.from)) ||
-            last_item.kind != new_item.kind) {
+    /* Must be called with queue_mutex locked.  A move must not overtake the changes queued before it in the
+     * folders it moves between, so those are sent first.  A file added since the last flush is not moved but
+     * added where it was moved to instead, as the directory does not know of it yet.
+     */
+    private static void queue_move (owned Change move) {
+        var from_parent = move.from.get_parent () ?? move.from;
+        var to_parent = move.to.get_parent () ?? move.to;
+        var from_batch = batches != null ? batches.lookup (from_parent) : null;
+        if (from_batch != null && from_batch.get_kind (move.from) == Kind.ADDED &&
+            !from_batch.is_replaced (move.from)) {
+
+            var is_internal = from_batch.is_internal (move.from);
+            add_to_batch (new Change () { kind = Kind.FILE_REMOVED, from = move.from, is_internal = true });
+            add_to_batch (new Change () { kind = Kind.ADDED, from = move.to, is_internal = is_internal });
+            return;
+        }
 
-            queue.push_head ((owned) new_item);
+        take_batch (from_parent);
+        if (!to_parent.equal (from_parent)) {
+            take_batch (to_parent);
         }
 
-        queue_mutex.unlock ();
+        steps.prepend (new Step () { move = (owned) move });
+    }
+
+    /* Must be called with queue_mutex locked */
+    private static void take_batch (GLib.File parent) {
+        if (batches == null) {
+            return;
+        }
+
+        var batch = batches.lookup (parent);
+        if (batch != null) {
+            batches.remove (parent);
+            steps.prepend (new Step () { batch = batch });
+        }
     }
 
     public static void queue_file_added (GLib.File location, bool internal_origin = true) {
@@ -117,141 +302,85 @@ namespace Files.FileChanges {
         queue_add_common ((owned) new_item);
     }
 
-    public static void consume_changes (bool consume_all) {
-        unowned GLib.Queue<Change> queue = get_queue ();
-        uint chunk_count;
-        bool flush_needed;
-        GLib.List<GLib.File>? changes = null;
-        GLib.List<GLib.File>? file_deletions = null;
-        GLib.List<GLib.File>? folder_deletions = null;
-        GLib.List<GLib.Array<GLib.File>>? moves = null;
-        GLib.List<Change>? additions = null;
-
-        /* Consume changes from the queue, stuffing them into one of three lists,
-         * keep doing it while the changes are of the same kind, then send them off.
-         * This is to ensure that the changes get sent off in the same order that they
-         * arrived.
-         */
-        for (chunk_count = 0; ; chunk_count++) {
-            queue_mutex.@lock ();
-            Change? change = queue.pop_tail ();
-            queue_mutex.unlock ();
-
-            /* figure out if we need to flush the pending changes that we collected sofar */
-
-            if (change == null) {
-                flush_needed = true;
-                /* no changes left, flush everything */
-            } else {
-                flush_needed = additions != null
-                    && change.kind != Files.FileChanges.Kind.ADDED;
-
-                flush_needed |= changes != null
-                    && change.kind != Files.FileChanges.Kind.CHANGED;
-
-                flush_needed |= moves != null
-                    && change.kind != Files.FileChanges.Kind.MOVED;
-
-                flush_needed |= file_deletions != null
-                    && change.kind != Files.FileChanges.Kind.FILE_REMOVED;
-
-                flush_needed |= folder_deletions != null
-                    && change.kind != Files.FileChanges.Kind.FOLDER_REMOVED;
-
-                flush_needed |= !consume_all && chunk_count >= CONSUME_CHANGES_MAX_CHUNK;
-                /* we have reached the chunk maximum */
-            }
+    /* The number of events queued and the number of changes sent to directories after merging */
+    public static void get_event_counts (out uint64 raw, out uint64 delivered) {
+        queue_mutex.@lock ();
+        raw = raw_events;
+        delivered = delivered_events;
+        queue_mutex.unlock ();
+    }
 
-            if (flush_needed) {
-                /* Send changes we collected off.
-                 * At one time we may only have one of the lists
-                 * contain changes.
-                 */
+    /* Sends the merged changes to the directories concerned, one batch per directory.  Moves are not merged and
+     * are sent first, in the order they were queued, each after the batches queued before it in the folders it
+     * moves between.  Unless @consume_all is set, at most CONSUME_CHANGES_MAX_CHUNK other directories are
+     * updated and the rest are left for the next flush.
+     */
+    public static void consume_changes (bool consume_all) {
+        GLib.List<Step>? pending_steps = null;
+        GLib.List<Batch>? pending_batches = null;
+        uint delivered = 0;
 
-                if (file_deletions != null) {
-                    file_deletions.reverse ();
-                    Files.Directory.notify_files_removed (file_deletions);
-                    file_deletions = null;
+        queue_mutex.@lock ();
+        pending_steps = (owned) steps;
+        steps = null;
+        pending_steps.reverse ();
+        if (batches != null) {
+            uint chunk_count = 0;
+            batches.foreach_remove ((parent, batch) => {
+                if (!consume_all && chunk_count >= CONSUME_CHANGES_MAX_CHUNK) {
+                    return false;
                 }
 
-                if (folder_deletions != null) {
-                    folder_deletions.reverse ();
-                    Files.Directory.notify_files_removed (folder_deletions);
-                    folder_deletions = null;
-                }
+                chunk_count++;
+                pending_batches.prepend (batch);
+                return true;
+            });
 
-                if (moves != null) {
-                    moves.reverse ();
-                    Files.Directory.notify_files_moved (moves);
-                    moves = null;
-                }
+            if (batches.size () > 0) {
+                schedule_flush ();
+            }
+        }
 
-                if (additions != null) {
-                    additions.reverse ();
-                    Files.Directory.notify_changes_added (additions);
-                    additions = null;
-                }
+        queue_mutex.unlock ();
 
-                if (changes != null) {
-                    changes.reverse ();
-                    Files.Directory.notify_files_changed (changes);
-                    changes = null;
-                }
+        /* Directories are updated without holding the lock as they may queue further changes */
+        GLib.List<GLib.Array<GLib.File>>? pending_moves = null;
+        foreach (unowned var step in pending_steps) {
+            if (step.move != null) {
+                var pair = new GLib.Array<GLib.File>.sized (false, false, sizeof (GLib.File), 2);
+                pair.append_val (step.move.from);
+                pair.append_val (step.move.to);
+                pending_moves.prepend (pair);
+                continue;
             }
 
-            if (change == null) {
-                /* we are done */
-                return;
+            if (pending_moves != null) {
+                pending_moves.reverse ();
+                delivered += pending_moves.length ();
+                Files.Directory.notify_files_moved (pending_moves);
+                pending_moves = null;
             }
 
-            /* add the new change to the list */
-            switch (change.kind) {
-                case Files.FileChanges.Kind.ADDED:
-                    if (additions == null) {
-                        additions = new GLib.List<Change> ();
-                    }
-
-                    additions.prepend ((owned)change);
-                    break;
-
-                case Files.FileChanges.Kind.CHANGED:
-                    if (changes == null) {
-                        changes = new GLib.List<GLib.File> ();
-                    }
-
-                    changes.prepend (change.from);
-                    break;
-
-                case Files.FileChanges.Kind.FILE_REMOVED:
-                    if (file_deletions == null) {
-                        file_deletions = new GLib.List<GLib.File> ();
-                    }
-
-                    file_deletions.prepend (change.from);
-                    break;
-
-                case Files.FileChanges.Kind.FOLDER_REMOVED:
-                    if (folder_deletions == null) {
-                        folder_deletions = new GLib.List<GLib.File> ();
-                    }
-
-                    folder_deletions.prepend (change.from);
-                    break;
+            delivered += step.batch.get_delivered_count ();
+            step.batch.dispatch ();
+        }
 
-                case Files.FileChanges.Kind.MOVED:
-                    if (moves == null) {
-                        moves = new GLib.List<GLib.Array<GLib.File>> ();
-                    }
+        if (pending_moves != null) {
+            pending_moves.reverse ();
+            delivered += pending_moves.length ();
+            Files.Directory.notify_files_moved (pending_moves);
+        }
 
-                    var pair = new GLib.Array<GLib.File>.sized (false, false, sizeof (GLib.File), 2);
-                    pair.append_val (change.from);
-                    pair.append_val (change.to);
-                    moves.prepend (pair);
-                    break;
+        foreach (unowned var batch in pending_batches) {
+            delivered += batch.get_delivered_count ();
+            batch.dispatch ();
+        }
 
-                default:
-                    GLib.assert_not_reached ();
-            }
+        if (delivered > 0) {
+            queue_mutex.@lock ();
+            delivered_events += delivered;
+            debug ("Delivered %u changes, %llu of %llu events in total", delivered, delivered_events, raw_events);
+            queue_mutex.unlock ();
         }
     }
 }
@@ -0,0 +1,304 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* Sorts all the rows of a model at once in the order given by Files.File.compare_for_sort (). The fields that
+ * compare_for_sort () would look at on every comparison are extracted once into an array of fixed-width keys
+ * holding the first bytes of collation keys, sizes, modification times and ranks. Slices of the array are sorted on
+ * separate threads and then merged. Full collation keys are only compared when the fixed-width keys are equal.
+ */
+public class Files.FileSorter {
+    /* Below this number of rows per thread, starting threads costs more than it saves */
+    private const uint MIN_ROWS_PER_THREAD = 16384;
+    private const int INSERTION_SORT_ROWS = 16;
+
+    /* Fields are in the order in which they are compared */
+    private struct SortKey {
+        /* Rows without a file first, then folders when sorting them first, then the rest. Not reversed. */
+        public uint8 group;
+        /* Folders before files when sorting by size or type */
+        public uint8 column_group;
+        /* Size, number of items in folders, or modification time with the newest first */
+        public uint64 primary;
+        public uint64 type_prefix;
+        /* Names starting with '.' or '#' last */
+        public uint8 sort_last;
+        public uint64 name_prefix;
+        /* The position of the row before sorting, which also keeps the sort stable */
+        public uint index;
+    }
+
+    private SortKey[] keys;
+    private SortKey[] scratch;
+    private unowned Files.File?[] files;
+    private string?[]? type_keys = null;
+    private int sort_column_id;
+    private bool directories_first;
+    private bool descending;
+
+    /* Returns the new order of @files, which may contain null for rows without a file, as expected by
+     * Gtk.TreeStore.reorder () and rows-reordered: new_order[new_position] = old_position */
+    public static int[] sort (Files.File?[] files, int sort_column_id, bool directories_first, Gtk.SortType order) {
+        var sorter = new FileSorter (files, sort_column_id, directories_first, order);
+        sorter.sort_keys ();
+
+        var new_order = new int[files.length];
+        for (int row = 0; row < files.length; row++) {
+            new_order[row] = (int) sorter.keys[row].index;
+        }
+
+        return new_order;
+    }
+
+    /* The position after the last of the sorted @files that sorts before or equal to @file. Only the keys of the
+     * rows visited by the binary search are extracted. */
+    public static int find_position (Files.File?[] files, Files.File file, int sort_column_id,
+                                     bool directories_first, Gtk.SortType order) {
+        /* The row being compared is first so that it sorts before @file when their columns are equal */
+        Files.File?[] pair = { null, file };
+        var sorter = new FileSorter (pair, sort_column_id, directories_first, order, false);
+        sorter.set_key (1);
+        int low = 0;
+        int high = files.length;
+        while (low < high) {
+            var mid = (low + high) / 2;
+            pair[0] = files[mid];
+            sorter.set_key (0);
+            if (sorter.compare (sorter.keys[0], sorter.keys[1]) < 0) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+
+        return low;
+    }
+
+    private FileSorter (Files.File?[] files, int sort_column_id, bool directories_first, Gtk.SortType order,
+                        bool set_keys = true) {
+        this.sort_column_id = sort_column_id;
+        this.directories_first = directories_first;
+        descending = order == Gtk.SortType.DESCENDING;
+        keys = new SortKey[files.length];
+        this.files = files;
+        if (sort_column_id == ListModel.ColumnID.TYPE) {
+            type_keys = new string?[files.length];
+        }
+
+        if (set_keys) {
+            scratch = new SortKey[files.length];
+            for (uint row = 0; row < files.length; row++) {
+                set_key (row);
+            }
+        }
+    }
+
+    /* Reading files, and counting the items in folders, must happen on this thread */
+    private void set_key (uint row) {
+        unowned var file = files[row];
+        keys[row] = SortKey () {
+            index = row
+        };
+
+        if (type_keys != null) {
+            type_keys[row] = null;
+        }
+
+        if (file == null || file.location == null) {
+            return; // group 0
+        }
+
+        var is_folder = file.is_folder ();
+        keys[row].group = directories_first && !is_folder ? 2 : 1;
+
+        switch (sort_column_id) {
+            case ListModel.ColumnID.SIZE:
+                keys[row].column_group = is_folder ? 0 : 1;
+                if (is_folder) {
+                    file.ensure_item_count (false);
+                    keys[row].primary = (uint64) (file.count + 1); // Unknown counts (-1) first
+                } else {
+                    keys[row].primary = file.size;
+                }
+
+                break;
+            case ListModel.ColumnID.TYPE:
+                keys[row].column_group = is_folder ? 0 : 1;
+                if (!is_folder) {
+                    /* Comparing collation keys is equivalent to comparing with string.collate () */
+                    type_keys[row] = (file.formated_type ?? "").collate_key ();
+                    keys[row].type_prefix = get_prefix (type_keys[row]);
+                }
+
+                break;
+            case ListModel.ColumnID.MODIFIED:
+                keys[row].primary = uint64.MAX - file.modified;
+                break;
+            default:
+                break;
+        }
+
+        unowned var name = file.get_display_name ();
+        keys[row].sort_last = name[0] == '.' || name[0] == '#' ? 1 : 0;
+        keys[row].name_prefix = get_prefix (file.utf8_collation_key);
+    }
+
+    /* The first eight bytes of @key so that comparing prefixes orders keys as GLib.strcmp () does */
+    private static uint64 get_prefix (string? key) {
+        uint64 prefix = 0;
+        bool ended = key == null;
+        for (int i = 0; i < 8; i++) {
+            prefix <<= 8;
+            if (!ended) {
+                if (key[i] == '\0') {
+                    ended = true;
+                } else {
+                    prefix |= (uint8) key[i];
+                }
+            }
+        }
+
+        return prefix;
+    }
+
+    private void sort_keys () {
+        var n_rows = keys.length;
+        var n_threads = (int) uint.min (GLib.get_num_processors (), (uint) n_rows / MIN_ROWS_PER_THREAD);
+        if (n_threads <= 1) {
+            merge_sort (0, n_rows);
+            return;
+        }
+
+        var bounds = new int[n_threads + 1];
+        for (int i = 0; i <= n_threads; i++) {
+            bounds[i] = (int) ((int64) n_rows * i / n_threads);
+        }
+
+        GLib.Thread<bool>[] threads = {};
+        for (int i = 0; i < n_threads; i++) {
+            var start = bounds[i];
+            var end = bounds[i + 1];
+            threads += new GLib.Thread<bool> ("file-sorter", () => {
+                merge_sort (start, end);
+                return true;
+            });
+        }
+
+        join_all (threads);
+
+        /* Merge neighbouring slices in rounds, each merge on its own thread */
+        for (int width = 1; width < n_threads; width *= 2) {
+            threads = {};
+            for (int i = 0; i + width < n_threads; i += 2 * width) {
+                var start = bounds[i];
+                var mid = bounds[i + width];
+                var end = bounds[int.min (i + 2 * width, n_threads)];
+                threads += new GLib.Thread<bool> ("file-sorter", () => {
+                    merge (start, mid, end);
+                    return true;
+                });
+            }
+
+            join_all (threads);
+        }
+    }
+
+    private static void join_all (GLib.Thread<bool>[] threads) {
+        foreach (var thread in threads) {
+            thread.join ();
+        }
+    }
+
+    /* Sorts keys[start:end] using the same range of scratch */
+    private void merge_sort (int start, int end) {
+        if (end - start <= INSERTION_SORT_ROWS) {
+            for (int i = start + 1; i < end; i++) {
+                var key = keys[i];
+                int j = i;
+                while (j > start && compare (keys[j - 1], key) > 0) {
+                    keys[j] = keys[j - 1];
+                    j--;
+                }
+
+                keys[j] = key;
+            }
+
+            return;
+        }
+
+        var mid = start + (end - start) / 2;
+        merge_sort (start, mid);
+        merge_sort (mid, end);
+        if (compare (keys[mid - 1], keys[mid]) > 0) {
+            merge (start, mid, end);
+        }
+    }
+
+    /* Merges the sorted ranges keys[start:mid] and keys[mid:end] */
+    private void merge (int start, int mid, int end) {
+        int left = start;
+        int right = mid;
+        int dest = start;
+        while (left < mid && right < end) {
+            if (compare (keys[right], keys[left]) < 0) {
+                scratch[dest++] = keys[right++];
+            } else {
+                scratch[dest++] = keys[left++];
+            }
+        }
+
+        while (left < mid) {
+            scratch[dest++] = keys[left++];
+        }
+
+        while (right < end) {
+            scratch[dest++] = keys[right++];
+        }
+
+        GLib.Memory.copy (&keys[start], &scratch[start], (end - start) * sizeof (SortKey));
+    }
+
+    /* Called on worker threads so must only read the keys */
+    private int compare (SortKey a, SortKey b) {
+        if (a.group != b.group) {
+            return a.group < b.group ? -1 : 1;
+        }
+
+        var result = compare_columns (a, b);
+        if (result == 0) {
+            return a.index < b.index ? -1 : (a.index > b.index ? 1 : 0);
+        }
+
+        return descending ? -result : result;
+    }
+
+    private int compare_columns (SortKey a, SortKey b) {
+        if (a.column_group != b.column_group) {
+            return a.column_group < b.column_group ? -1 : 1;
+        }
+
+        if (a.primary != b.primary) {
+            return a.primary < b.primary ? -1 : 1;
+        }
+
+        if (a.type_prefix != b.type_prefix) {
+            return a.type_prefix < b.type_prefix ? -1 : 1;
+        } else if (type_keys != null) {
+            var result = GLib.strcmp (type_keys[a.index], type_keys[b.index]);
+            if (result != 0) {
+                return result;
+            }
+        }
+
+        if (a.sort_last != b.sort_last) {
+            return a.sort_last < b.sort_last ? -1 : 1;
+        }
+
+        if (a.name_prefix != b.name_prefix) {
+            return a.name_prefix < b.name_prefix ? -1 : 1;
+        }
+
+        return GLib.strcmp (files[a.index].utf8_collation_key, files[b.index].utf8_collation_key);
+    }
+}
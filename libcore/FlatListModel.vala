@@ -0,0 +1,366 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* A model for views that do not expand subfolders. Rows are kept in one array of files in display order, so a row
+ * costs a pointer plus an entry in the table mapping files to rows, instead of a tree node, a row reference and a
+ * uri per row as in a Gtk.TreeStore. Sorting permutes the array. Iterators hold the row number and are only valid
+ * until the model next changes.
+ */
+public class Files.FlatListModel : GLib.Object, Gtk.TreeModel, Gtk.TreeSortable, Files.DirectoryModel {
+    public bool show_hidden_files { get; set; default = false; }
+    public bool is_empty {
+        get {
+            return rows.length == 0;
+        }
+    }
+
+    public int icon_size { get; set; default = 32; }
+    public bool has_child { get; set; default = false; }
+    public bool sort_pending {
+        get {
+            return resort_timeout_id > 0;
+        }
+    }
+
+    private GLib.GenericArray<Files.File> rows;
+    /* The rows of files. The keys are always the files in the model but only the rows before first_dirty_row are
+     * valid. Rows from there on are renumbered when looked up, up to the row looked up. */
+    private GLib.HashTable<unowned Files.File, uint> row_numbers;
+    private uint first_dirty_row = 0;
+    private int stamp;
+    private int sort_column_id = ListModel.ColumnID.FILENAME;
+    private Gtk.SortType sort_order = Gtk.SortType.ASCENDING;
+    private bool sorting_on = false;
+    private bool sort_directories_first = true;
+    private uint resort_timeout_id = 0;
+    private bool delay_resort = true;
+    /* Whether the pending resort must sort, rather than only emit rows-reordered for files inserted in place */
+    private bool needs_sort = false;
+
+    construct {
+        rows = new GLib.GenericArray<Files.File> ();
+        row_numbers = new GLib.HashTable<unowned Files.File, uint> (direct_hash, direct_equal);
+        stamp = (int) GLib.Random.next_int ();
+    }
+
+    public Files.File? file_for_path (Gtk.TreePath path) {
+        var row = get_row_for_path (path);
+        return row >= 0 ? rows[row] : null;
+    }
+
+    public Files.File? file_for_iter (Gtk.TreeIter iter) {
+        var row = get_row_for_iter (iter);
+        return row >= 0 ? rows[row] : null;
+    }
+
+    public uint get_length () {
+        return rows.length;
+    }
+
+    public Gtk.TreePath? get_path_for_first_file (Files.File? file) {
+        var row = get_row_for_file (file);
+        return row >= 0 ? new Gtk.TreePath.from_indices (row) : null;
+    }
+
+    public bool add_file (Files.File file, Files.Directory dir) {
+        if (file in row_numbers) {
+            return false; // The file is already in the model - ignore the request to add
+        }
+
+        append_row (file);
+        return true;
+    }
+
+    public bool insert_sorted (Files.File file, Files.Directory dir) {
+        if (file in row_numbers) {
+            return false;
+        }
+
+        if (sorting_on) {
+            insert_row (file, FileSorter.find_position (rows.data, file, sort_column_id, sort_directories_first,
+                                                        sort_order));
+        } else {
+            append_row (file);
+        }
+
+        /* Callers expect rows-reordered once the file is in place, but the rows are still sorted */
+        resort (false);
+        return true;
+    }
+
+    public bool remove_file (Files.File file, Files.Directory dir) {
+        var row = get_row_for_file (file);
+        if (row < 0) {
+            return false;
+        }
+
+        row_numbers.remove (file);
+        rows.remove_index (row);
+        first_dirty_row = uint.min (first_dirty_row, (uint) row);
+        stamp++;
+        row_deleted (new Gtk.TreePath.from_indices (row));
+        return true;
+    }
+
+    public void file_changed (Files.File file, Files.Directory dir) {
+        var row = get_row_for_file (file);
+        if (row < 0) {
+            add_file (file, dir);
+            return;
+        }
+
+        Gtk.TreeIter iter;
+        make_iter (out iter, row);
+        row_changed (new Gtk.TreePath.from_indices (row), iter);
+    }
+
+    public void clear () {
+        /* Deleting from the end avoids renumbering the remaining rows in views */
+        for (int row = (int) rows.length - 1; row >= 0; row--) {
+            row_numbers.remove (rows[row]);
+            rows.remove_index (row);
+            stamp++;
+            row_deleted (new Gtk.TreePath.from_indices (row));
+        }
+
+        first_dirty_row = 0;
+    }
+
+    public void set_sorting_off () {
+        sorting_on = false;
+    }
+
+    public void set_sorting_on () {
+        sorting_on = true;
+        sort_rows ();
+    }
+
+    public void set_should_sort_directories_first (bool sort_directories_first) {
+        if (this.sort_directories_first == sort_directories_first) {
+            return;
+        }
+
+        this.sort_directories_first = sort_directories_first;
+        resort ();
+    }
+
+    /* Gtk.TreeSortable */
+    public bool get_sort_column_id (out int sort_column_id, out Gtk.SortType order) {
+        sort_column_id = this.sort_column_id;
+        order = sort_order;
+        return sort_column_id >= 0;
+    }
+
+    public void set_sort_column_id (int sort_column_id, Gtk.SortType order) {
+        if (sort_column_id == this.sort_column_id && order == sort_order) {
+            return;
+        }
+
+        this.sort_column_id = sort_column_id;
+        sort_order = order;
+        sort_column_changed ();
+        sort_rows ();
+    }
+
+    /* Files are always compared with Files.File.compare_for_sort () */
+    public void set_sort_func (int sort_column_id, owned Gtk.TreeIterCompareFunc sort_func) {}
+    public void set_default_sort_func (owned Gtk.TreeIterCompareFunc sort_func) {}
+    public bool has_default_sort_func () {
+        return false;
+    }
+
+    /* Gtk.TreeModel */
+    public Gtk.TreeModelFlags get_flags () {
+        return Gtk.TreeModelFlags.LIST_ONLY;
+    }
+
+    public int get_n_columns () {
+        return ListModel.ColumnID.NUM_COLUMNS + 1; // Includes the dummy column of ListModel
+    }
+
+    public GLib.Type get_column_type (int index) {
+        return ListModel.get_column_type_static (index);
+    }
+
+    public bool get_iter (out Gtk.TreeIter iter, Gtk.TreePath path) {
+        return make_iter (out iter, get_row_for_path (path));
+    }
+
+    public Gtk.TreePath? get_path (Gtk.TreeIter iter) {
+        var row = get_row_for_iter (iter);
+        return row >= 0 ? new Gtk.TreePath.from_indices (row) : null;
+    }
+
+    public void get_value (Gtk.TreeIter iter, int column, out GLib.Value value) {
+        var row = get_row_for_iter (iter);
+        ListModel.get_file_value (row >= 0 ? rows[row] : null, column, icon_size, out value);
+    }
+
+    public bool iter_next (ref Gtk.TreeIter iter) {
+        var row = get_row_for_iter (iter);
+        return make_iter (out iter, row >= 0 ? row + 1 : -1);
+    }
+
+    public bool iter_previous (ref Gtk.TreeIter iter) {
+        var row = get_row_for_iter (iter);
+        return make_iter (out iter, row >= 0 ? row - 1 : -1);
+    }
+
+    public bool iter_children (out Gtk.TreeIter iter, Gtk.TreeIter? parent) {
+        return make_iter (out iter, parent == null ? 0 : -1);
+    }
+
+    public bool iter_has_child (Gtk.TreeIter iter) {
+        return false;
+    }
+
+    public int iter_n_children (Gtk.TreeIter? iter) {
+        return iter == null ? (int) rows.length : 0;
+    }
+
+    public bool iter_nth_child (out Gtk.TreeIter iter, Gtk.TreeIter? parent, int n) {
+        return make_iter (out iter, parent == null ? n : -1);
+    }
+
+    public bool iter_parent (out Gtk.TreeIter iter, Gtk.TreeIter child) {
+        return make_iter (out iter, -1);
+    }
+
+    /* Returns false and an invalid iter if @row is out of range */
+    private bool make_iter (out Gtk.TreeIter iter, int row) {
+        iter = Gtk.TreeIter ();
+        if (row < 0 || row >= rows.length) {
+            iter.stamp = 0;
+            return false;
+        }
+
+        iter.stamp = stamp;
+        iter.user_data = (void*) (ulong) row;
+        return true;
+    }
+
+    private int get_row_for_iter (Gtk.TreeIter iter) {
+        if (iter.stamp != stamp) {
+            return -1;
+        }
+
+        var row = (int) (ulong) iter.user_data;
+        return row < rows.length ? row : -1;
+    }
+
+    private int get_row_for_path (Gtk.TreePath path) {
+        if (path.get_depth () != 1) {
+            return -1;
+        }
+
+        var row = path.get_indices ()[0];
+        return row >= 0 && row < rows.length ? row : -1;
+    }
+
+    private int get_row_for_file (Files.File? file) {
+        if (file == null || !(file in row_numbers)) {
+            return -1;
+        }
+
+        /* A row from before an insertion may be below first_dirty_row but no longer hold the file */
+        var row = row_numbers.lookup (file);
+        if (row < first_dirty_row && rows[row] == file) {
+            return (int) row;
+        }
+
+        /* Otherwise the file is at or after first_dirty_row */
+        for (row = first_dirty_row; rows[row] != file; row++) {
+            row_numbers.insert (rows[row], row);
+        }
+
+        row_numbers.insert (file, row);
+        first_dirty_row = row + 1;
+        return (int) row;
+    }
+
+    private void append_row (Files.File file) {
+        insert_row (file, (int) rows.length);
+    }
+
+    private void insert_row (Files.File file, int row) {
+        if (row == rows.length) {
+            rows.add (file);
+        } else {
+            rows.insert (row, file);
+        }
+
+        row_numbers.insert (file, row);
+        if (first_dirty_row >= row) {
+            first_dirty_row = (uint) row + 1; // The rows after it moved
+        }
+
+        stamp++;
+        Gtk.TreeIter iter;
+        make_iter (out iter, row);
+        row_inserted (new Gtk.TreePath.from_indices (row), iter);
+    }
+
+    /* Sorts the rows once changes stop, or only emits rows-reordered if the rows are known to be sorted */
+    private void resort (bool sort = true) {
+        needs_sort = needs_sort || sort;
+        if (!sort_pending) {
+            resort_timeout_id = Idle.add (() => {
+                if (delay_resort) {
+                    delay_resort = false;
+                    return Source.CONTINUE;
+                } else {
+                    delay_resort = true;
+                    resort_timeout_id = 0;
+                    if (needs_sort) {
+                        needs_sort = false;
+                        sort_rows ();
+                    } else {
+                        notify_rows_reordered ();
+                    }
+
+                    return Source.REMOVE;
+                }
+            });
+        } else {
+            delay_resort = true;
+        }
+    }
+
+    /* Sorts the rows if sorting is on and emits rows-reordered even if no row moved */
+    private void sort_rows () {
+        if (!sorting_on || rows.length == 0 || sort_column_id < 0) {
+            return;
+        }
+
+        var new_order = FileSorter.sort (rows.data, sort_column_id, sort_directories_first, sort_order);
+        var sorted_rows = new GLib.GenericArray<Files.File> (rows.length);
+        for (uint row = 0; row < new_order.length; row++) {
+            unowned var file = rows[new_order[row]];
+            sorted_rows.add (file);
+            row_numbers.insert (file, row);
+        }
+
+        rows = sorted_rows;
+        first_dirty_row = rows.length;
+
+        stamp++;
+        rows_reordered_with_length (new Gtk.TreePath (), null, new_order);
+    }
+
+    /* Emits rows-reordered without moving any row, as sort_rows () does when the rows are already sorted */
+    private void notify_rows_reordered () {
+        if (!sorting_on || rows.length == 0 || sort_column_id < 0) {
+            return;
+        }
+
+        var new_order = new int[rows.length];
+        for (int row = 0; row < new_order.length; row++) {
+            new_order[row] = row;
+        }
+
+        stamp++;
+        rows_reordered_with_length (new Gtk.TreePath (), null, new_order);
+    }
+}
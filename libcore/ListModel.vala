@@ -16,7 +16,7 @@
  * Boston, MA 02110-1301, USA.
  */
 
-public class Files.ListModel : Gtk.TreeStore, Gtk.TreeModel {
+public class Files.ListModel : Gtk.TreeStore, Gtk.TreeModel, Gtk.TreeSortable, Files.DirectoryModel {
     public enum ColumnID {
         FILE_COLUMN,
         COLOR,
@@ -76,6 +76,7 @@ public class Files.ListModel : Gtk.TreeStore, Gtk.TreeModel {
     public bool has_child { get; set; default = false; }
 
     private bool sort_directories_first = true;
+    private bool sorting_on = false;
 
     private Gee.TreeMap<string?, Gtk.TreeRowReference> file_treerow_map;
 
@@ -93,24 +94,41 @@ public class Files.ListModel : Gtk.TreeStore, Gtk.TreeModel {
             typeof (bool)
         });
 
+        for (int i = 0; i < ColumnID.NUM_COLUMNS; i++) {
+            set_sort_func (i, (Gtk.TreeIterCompareFunc) file_entry_compare_func);
+        }
+
         set_sort_column_id (
             ColumnID.FILENAME,
             Gtk.SortType.ASCENDING
         );
-        set_sorting_off ();
     }
 
     // Turn off sorting while files are being added
     public void set_sorting_off () {
-        for (int i = 0; i < ColumnID.NUM_COLUMNS; i++) {
-            set_sort_func (i, () => {return 0;});
-        }
+        sorting_on = false;
     }
 
     // Turn on sorting after model stops loading.
     public void set_sorting_on () {
-        for (int i = 0; i < ColumnID.NUM_COLUMNS; i++) {
-            set_sort_func (i, (Gtk.TreeIterCompareFunc) file_entry_compare_func);
+        sorting_on = true;
+        sort_rows ();
+    }
+
+    /* Gtk.TreeSortable. Changing the sort column sorts every row with a Files.FileSorter instead of comparing rows
+     * with file_entry_compare_func (), which is only used to place rows added while sorting is on. */
+    public void set_sort_column_id (int sort_column_id, Gtk.SortType order) {
+        int current_sort_column_id;
+        Gtk.SortType current_order;
+        base.get_sort_column_id (out current_sort_column_id, out current_order);
+        if (sort_column_id == current_sort_column_id && order == current_order) {
+            return;
+        }
+
+        if (sorting_on && sort_column_id >= 0) {
+            sort_rows_by (sort_column_id, order);
+        } else {
+            base.set_sort_column_id (sort_column_id, order);
         }
     }
 
@@ -170,8 +188,25 @@ public class Files.ListModel : Gtk.TreeStore, Gtk.TreeModel {
     public void get_value (Gtk.TreeIter iter, int column, out Value value) {
         Value file_value;
         base.get_value (iter, ColumnID.FILE_COLUMN, out file_value);
-        unowned Files.File? file = (Files.File) file_value.get_object ();
+        get_file_value ((Files.File) file_value.get_object (), column, icon_size, out value);
+    }
+
+    /* The types set in construct */
+    internal static GLib.Type get_column_type_static (int column) {
+        switch (column) {
+            case ColumnID.FILE_COLUMN:
+                return typeof (Files.File);
+            case ColumnID.PIXBUF:
+                return typeof (Gdk.Pixbuf);
+            case PrivColumnID.DUMMY:
+                return typeof (bool);
+            default:
+                return column >= 0 && column < ColumnID.NUM_COLUMNS ? typeof (string) : GLib.Type.INVALID;
+        }
+    }
 
+    /* The value of @column for a row holding @file, which is null for dummy rows */
+    internal static void get_file_value (Files.File? file, int column, int icon_size, out Value value) {
         switch (column) {
             case ColumnID.FILE_COLUMN:
                 value = Value (typeof (Files.File));
@@ -290,15 +325,7 @@ public class Files.ListModel : Gtk.TreeStore, Gtk.TreeModel {
                     return Source.CONTINUE;
                 } else {
                     delay_resort = true;
-                    int sort_column_id;
-                    Gtk.SortType order;
-                    if (!get_sort_column_id (out sort_column_id, out order)) {
-                        sort_column_id = ColumnID.FILENAME;
-                        order = Gtk.SortType.ASCENDING;
-                    }
-
-                    set_sort_column_id (Gtk.TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID, order);
-                    set_sort_column_id (sort_column_id, order);
+                    sort_rows ();
                     resort_timeout_id = 0;
                     return Source.REMOVE;
                 }
@@ -477,7 +504,60 @@ public class Files.ListModel : Gtk.TreeStore, Gtk.TreeModel {
         base.clear ();
     }
 
+    /* Sorts every level of the tree if sorting is on, emitting rows-reordered for each level even if no row moved */
+    private void sort_rows () {
+        int sort_column_id;
+        Gtk.SortType order;
+        if (sorting_on && get_sort_column_id (out sort_column_id, out order)) {
+            sort_rows_by (sort_column_id, order);
+        }
+    }
+
+    private void sort_rows_by (int sort_column_id, Gtk.SortType order) {
+        /* Gtk.TreeStore only allows reordering rows while unsorted. It sorts again when the sort column is set,
+         * which keeps the new order while file_entry_compare_func () is turned off. */
+        sorting_on = false;
+        base.set_sort_column_id (Gtk.TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID, order);
+        sort_level (null, sort_column_id, order);
+        base.set_sort_column_id (sort_column_id, order);
+        sorting_on = true;
+    }
+
+    private void sort_level (Gtk.TreeIter? parent, int sort_column_id, Gtk.SortType order) {
+        var n_rows = iter_n_children (parent);
+        if (n_rows == 0) {
+            return;
+        }
+
+        var files = new Files.File?[n_rows];
+        var iters = new Gtk.TreeIter[n_rows];
+        Gtk.TreeIter iter;
+        iter_children (out iter, parent);
+        for (int row = 0; row < n_rows; row++) {
+            Files.File? file = null;
+            get (iter, ColumnID.FILE_COLUMN, out file);
+            files[row] = file;
+            iters[row] = iter;
+            iter_next (ref iter);
+        }
+
+        if (n_rows > 1) {
+            reorder (parent, FileSorter.sort (files, sort_column_id, sort_directories_first, order));
+        }
+
+        /* Iters of a Gtk.TreeStore stay valid when rows are reordered */
+        foreach (var child in iters) {
+            if (iter_has_child (child)) {
+                sort_level (child, sort_column_id, order);
+            }
+        }
+    }
+
     private int file_entry_compare_func (Gtk.TreeIter a, Gtk.TreeIter b) {
+        if (!sorting_on) {
+            return 0;
+        }
+
         Files.File? file_a = null;
         Files.File? file_b = null;
         get (a, ColumnID.FILE_COLUMN, out file_a);
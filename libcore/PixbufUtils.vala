@@ -17,14 +17,14 @@
  */
 
 namespace PF.PixbufUtils {
-    private uint8 lighten_component (uint8 cur_value) {
-        uint new_value = cur_value;
-        new_value += 24 + (new_value >> 3);
-        if (new_value > uint8.MAX) {
-            new_value = uint8.MAX;
-        }
+    /* Results are attached to the source pixbuf so that they are reused for as long as the source lives.
+     * This avoids recomputing the effect for every frame drawn while an icon is hovered, selected or cut. */
+    private Gdk.Pixbuf? get_cached (Gdk.Pixbuf src, string effect) {
+        return src.get_data<Gdk.Pixbuf> ("pf-pixbuf-utils-" + effect);
+    }
 
-        return (uint8) new_value;
+    private void set_cached (Gdk.Pixbuf src, string effect, Gdk.Pixbuf dest) {
+        src.set_data<Gdk.Pixbuf> ("pf-pixbuf-utils-" + effect, dest);
     }
 
     public Gdk.Pixbuf lighten (Gdk.Pixbuf src) {
@@ -32,27 +32,13 @@ namespace PF.PixbufUtils {
                                  src);
         GLib.return_val_if_fail (src.bits_per_sample == 8, src);
 
-        var width = src.width;
-        var height = src.height;
-        var channels = src.n_channels;
-        var has_alpha = src.has_alpha;
-        var dest = new Gdk.Pixbuf (src.colorspace, src.has_alpha, src.bits_per_sample, width, height);
-        var dst_row_stride = dest.rowstride;
-        var src_row_stride = src.rowstride;
-        unowned uint8[] target_pix = (uint8[])dest.pixels;
-        unowned uint8[] original_pix = (uint8[])src.pixels;
-        for (int i = 0; i < height; i++) {
-            int src_row = i * src_row_stride;
-            int dst_row = i * dst_row_stride;
-            for (int j = 0; j < width; j++) {
-                var width_offset = j * channels;
-                target_pix[dst_row + width_offset] = lighten_component (original_pix[src_row + width_offset]);
-                target_pix[dst_row + width_offset + 1] = lighten_component (original_pix[src_row + width_offset + 1]);
-                target_pix[dst_row + width_offset + 2] = lighten_component (original_pix[src_row + width_offset + 2]);
-                if (has_alpha) {
-                    target_pix[dst_row + width_offset + 3] = original_pix[src_row + width_offset + 3];
-                }
-            }
+        var dest = get_cached (src, "lighten");
+        if (dest == null) {
+            dest = new Gdk.Pixbuf (src.colorspace, src.has_alpha, src.bits_per_sample, src.width, src.height);
+            Kernels.lighten ((uint8[]) src.pixels, src.rowstride, (uint8[]) dest.pixels, dest.rowstride,
+                             src.width, src.height, src.n_channels);
+
+            set_cached (src, "lighten", dest);
         }
 
         return dest;
@@ -63,33 +49,14 @@ namespace PF.PixbufUtils {
                                  src);
         GLib.return_val_if_fail (src.bits_per_sample == 8, src);
 
-        var width = src.width;
-        var height = src.height;
-        var has_alpha = src.has_alpha;
-        var channels = src.n_channels;
-        var dest = new Gdk.Pixbuf (src.colorspace, has_alpha, src.bits_per_sample, width, height);
-        var dst_row_stride = dest.rowstride;
-        var src_row_stride = src.rowstride;
-        unowned uint8[] target_pix = (uint8[])dest.pixels;
-        unowned uint8[] original_pix = (uint8[])src.pixels;
-        for (int i = 0; i < height; i++) {
-            int src_row = i * src_row_stride;
-            int dst_row = i * dst_row_stride;
-            for (int j = 0; j < width; j++) {
-                var width_offset = j * channels;
-                uint8 r = original_pix[src_row + width_offset];
-                uint8 g = original_pix[src_row + width_offset + 1];
-                uint8 b = original_pix[src_row + width_offset + 2];
-                uint8 intensity = (r * 77 + g * 150 + b * 28) >> 8;
-                uint8 negalpha = ((uint8.MAX - saturation) * darken) >> 8;
-                uint8 alpha = (saturation * darken) >> 8;
-                target_pix[dst_row + width_offset] = (negalpha * intensity + alpha * r) >> 8;
-                target_pix[dst_row + width_offset + 1] = (negalpha * intensity + alpha * g) >> 8;
-                target_pix[dst_row + width_offset + 2] = (negalpha * intensity + alpha * b) >> 8;
-                if (has_alpha) {
-                    target_pix[dst_row + width_offset + 3] = original_pix[src_row + width_offset + 3];
-                }
-            }
+        var effect = "darken-%u-%u".printf (saturation, darken);
+        var dest = get_cached (src, effect);
+        if (dest == null) {
+            dest = new Gdk.Pixbuf (src.colorspace, src.has_alpha, src.bits_per_sample, src.width, src.height);
+            Kernels.darken ((uint8[]) src.pixels, src.rowstride, (uint8[]) dest.pixels, dest.rowstride,
+                            src.width, src.height, src.n_channels, saturation, darken);
+
+            set_cached (src, effect, dest);
         }
 
         return dest;
@@ -97,43 +64,18 @@ namespace PF.PixbufUtils {
 
     public Gdk.Pixbuf lucent (Gdk.Pixbuf src, uint percent) {
         GLib.return_val_if_fail (percent <= 100, src);
+        GLib.return_val_if_fail ((!src.has_alpha && src.n_channels == 3) || (src.has_alpha && src.n_channels == 4),
+                                 src);
+        GLib.return_val_if_fail (src.bits_per_sample == 8, src);
+
+        var effect = "lucent-%u".printf (percent);
+        var dest = get_cached (src, effect);
+        if (dest == null) {
+            dest = new Gdk.Pixbuf (src.colorspace, true, src.bits_per_sample, src.width, src.height);
+            Kernels.lucent ((uint8[]) src.pixels, src.rowstride, (uint8[]) dest.pixels, dest.rowstride,
+                            src.width, src.height, src.n_channels, percent);
 
-        var width = src.width;
-        var height = src.height;
-        var has_alpha = src.has_alpha;
-        var dest = new Gdk.Pixbuf (src.colorspace, true, src.bits_per_sample, width, height);
-        var dst_row_stride = dest.rowstride;
-        var src_row_stride = src.rowstride;
-        unowned uint8[] target_pix = (uint8[])dest.pixels;
-        unowned uint8[] original_pix = (uint8[])src.pixels;
-        if (has_alpha) {
-            var ratio = (double)percent / 100;
-            for (int i = 0; i < height; i++) {
-                int src_row = i * src_row_stride;
-                int dst_row = i * dst_row_stride;
-                for (int j = 0; j < width; j++) {
-                    var dr = dst_row + j * 4;
-                    var sr = src_row + j * 4;
-                    target_pix[dr++] = original_pix[sr++];
-                    target_pix[dr++] = original_pix[sr++];
-                    target_pix[dr++] = original_pix[sr++];
-                    target_pix[dr] = (uint8)(original_pix[sr] * ratio);
-                }
-            }
-        } else {
-            percent = (255u * percent) / 100u;
-            for (int i = 0; i < height; i++) {
-                int src_row = i * src_row_stride;
-                int dst_row = i * dst_row_stride;
-                for (int j = 0; j < width; j++) {
-                    var dr = dst_row + j * 4;
-                    var sr = src_row + j * 3;
-                    target_pix[dr++] = original_pix[sr++];
-                    target_pix[dr++] = original_pix[sr++];
-                    target_pix[dr++] = original_pix[sr++];
-                    target_pix[dr] = (uint8)percent;
-                }
-            }
+            set_cached (src, effect, dest);
         }
 
         return dest;
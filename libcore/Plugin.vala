@@ -19,11 +19,27 @@
 public abstract class Files.Plugins.Base {
     public virtual void directory_loaded (Gtk.ApplicationWindow window, Files.AbstractSlot view, Files.File directory) { }
     public virtual void context_menu (Gtk.Widget widget, List<Files.File> files) { }
+
+    /* Called instead of context_menu () when the view can also provide its totals for the selected files */
+    public virtual void context_menu_for_selection (Gtk.Widget widget, List<Files.File> files,
+                                                   Files.SelectionSet? selection) {
+        context_menu (widget, files);
+    }
+
     public virtual void sidebar_loaded (Gtk.Widget widget) { }
     public virtual void update_sidebar (Gtk.Widget widget) { }
     public virtual void update_file_info (Files.File file) { }
 
+    /* Called by the plugin manager with batches of files, on a worker thread if thread_safe is set */
+    public virtual void update_files_info (List<Files.File> files) {
+        foreach (unowned var file in files) {
+            update_file_info (file);
+        }
+    }
+
     public Gtk.Widget window;
+    /* Set by plugins whose update_files_info () may run on a worker thread */
+    public bool thread_safe = false;
 
     public void interface_loaded (Gtk.Widget widget) {
         window = widget;
@@ -22,14 +22,150 @@
 public static Files.PluginManager plugins;
 
 public class Files.PluginManager : Object {
+    /* Files are passed to plugins in batches of at most this number, or fewer for slow plugins */
+    private const int BATCH_SIZE = 256;
+    private const int SLOW_BATCH_SIZE = 32;
+    /* Plugins taking longer than this for a batch several times in a row are treated as slow */
+    private const int64 BATCH_BUDGET_USEC = 20000;
+    private const uint MAX_SLOW_BATCHES = 3;
+
+    /* The files waiting to be passed to a plugin and how long it has been taking */
+    private class FileInfoQueue {
+        public Plugins.Base plugin;
+        public string name;
+        public PluginStats stats;
+        public Gee.HashSet<Files.File> pending;
+        public uint source_id = 0;
+        public bool is_dispatching = false;
+        public uint slow_batches = 0;
+        public bool is_slow = false;
+
+        public FileInfoQueue (Plugins.Base plugin, string name, PluginStats stats) {
+            this.plugin = plugin;
+            this.name = name;
+            this.stats = stats;
+            pending = new Gee.HashSet<Files.File> ();
+        }
+
+        public GLib.List<Files.File> take_batch () {
+            GLib.List<Files.File> batch = null;
+            var n_files = is_slow ? SLOW_BATCH_SIZE : BATCH_SIZE;
+            var iter = pending.iterator ();
+            while (n_files-- > 0 && iter.next ()) {
+                batch.prepend (iter.get ());
+                iter.remove ();
+            }
+
+            return batch;
+        }
+    }
+
+    /* A plugin whose keyfile has a Triggers group. Its module is only loaded when a hook listed in Hooks is first
+     * called, or when a folder is loaded whose URI scheme is listed in Schemes or which is in a folder containing one
+     * of the files listed in Markers.
+     */
+    private class LazyPlugin {
+        public string file_path;
+        public string name;
+        public string[] hooks;
+        public string[] schemes;
+        public string[] markers;
+
+        private const uint MAX_CHECKED_DIRS = 4096;
+        /* Folders above loaded folders that were found to contain no marker */
+        private GLib.GenericSet<string> checked_dirs;
+
+        public LazyPlugin (string file_path, string name, KeyFile keyfile) {
+            this.file_path = file_path;
+            this.name = name;
+            hooks = get_list (keyfile, "Hooks");
+            schemes = get_list (keyfile, "Schemes");
+            markers = get_list (keyfile, "Markers");
+            checked_dirs = new GLib.GenericSet<string> (str_hash, str_equal);
+        }
+
+        public bool is_triggered (string hook, string? scheme, string? path) {
+            if (hook in hooks || (scheme != null && scheme in schemes)) {
+                return true;
+            }
+
+            if (path == null || markers.length == 0) {
+                return false;
+            }
+
+            /* The loaded folder is always checked, but the folders above it are remembered once found to contain no
+             * marker so that loading folders in the same tree does not check their parents again.
+             */
+            if (has_marker (path)) {
+                return true;
+            }
+
+            var parents = new GLib.GenericArray<string> ();
+            var dir = Path.get_dirname (path);
+            while (!(dir in checked_dirs)) {
+                if (has_marker (dir)) {
+                    return true;
+                }
+
+                parents.add (dir);
+                var parent = Path.get_dirname (dir);
+                if (parent == dir) {
+                    break;
+                }
+
+                dir = parent;
+            }
+
+            /* A folder is only remembered together with all the folders above it */
+            if (checked_dirs.length + parents.length > MAX_CHECKED_DIRS) {
+                checked_dirs.remove_all ();
+            } else {
+                foreach (unowned var checked_dir in parents.data) {
+                    checked_dirs.add (checked_dir);
+                }
+            }
+
+            return false;
+        }
+
+        private bool has_marker (string dir) {
+            foreach (unowned var marker in markers) {
+                if (GLib.FileUtils.test (Path.build_filename (dir, marker), GLib.FileTest.EXISTS)) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        private static string[] get_list (KeyFile keyfile, string key) {
+            try {
+                if (keyfile.has_key ("Triggers", key)) {
+                    return keyfile.get_string_list ("Triggers", key);
+                }
+            } catch (KeyFileError e) {
+                warning ("Invalid %s in plugin keyfile: %s", key, e.message);
+            }
+
+            return {};
+        }
+    }
 
     delegate Plugins.Base ModuleInitFunc ();
     Gee.HashMap<string,Plugins.Base> plugin_hash;
+    Gee.HashMap<string,LazyPlugin> lazy_plugins;
+    Gee.HashMap<string,FileInfoQueue> file_info_queues;
+    Gee.HashMap<string,PluginStats> plugin_stats;
     Gee.List<string> names;
     bool in_available = false;
     bool update_queued = false;
     bool is_admin = false;
 
+    /* What loaded plugins have been given, to pass on to plugins loaded later */
+    GLib.WeakRef last_window;
+    GLib.WeakRef last_view;
+    GLib.WeakRef last_directory;
+
     public Gee.List<Gtk.Widget> menuitem_references { get; private set; }
 
     private string[] plugin_dirs;
@@ -37,6 +173,9 @@ public class Files.PluginManager : Object {
     public PluginManager (string plugin_dir, uint user_id) {
         is_admin = (user_id == 0);
         plugin_hash = new Gee.HashMap<string,Plugins.Base> ();
+        lazy_plugins = new Gee.HashMap<string,LazyPlugin> ();
+        file_info_queues = new Gee.HashMap<string,FileInfoQueue> ();
+        plugin_stats = new Gee.HashMap<string,PluginStats> ();
         names = new Gee.ArrayList<string> ();
         menuitem_references = new Gee.LinkedList<Gtk.Widget> ();
         plugin_dirs = new string[0];
@@ -55,10 +194,13 @@ public class Files.PluginManager : Object {
     }
 
     private void load_plugins () {
+        var start_time = get_monotonic_time ();
         load_modules_from_dir (plugin_dirs[0]);
         in_available = true;
         load_modules_from_dir (plugin_dirs[1]);
         in_available = false;
+        debug ("Loaded %i plugins in %i ms, %i plugins will be loaded when needed", plugin_hash.size,
+               (int) ((get_monotonic_time () - start_time) / 1000), lazy_plugins.size);
     }
 
     private void set_directory_monitor (string path) {
@@ -126,6 +268,7 @@ public class Files.PluginManager : Object {
 
         debug ("Loading plugin for %s", file_path);
 
+        var start_time = get_monotonic_time ();
         Module module = Module.open (file_path, ModuleFlags.LOCAL);
         if (module == null) {
             warning ("Failed to load module from path '%s': %s",
@@ -155,6 +298,10 @@ public class Files.PluginManager : Object {
 
         if (plug != null) {
             plugin_hash.set (file_path, plug);
+            var stats = new PluginStats (name);
+            stats.record ("load", get_monotonic_time () - start_time);
+            plugin_stats.set (file_path, stats);
+            file_info_queues.set (file_path, new FileInfoQueue (plug, name, stats));
         }
 
         if (in_available) {
@@ -167,56 +314,222 @@ public class Files.PluginManager : Object {
         try {
             keyfile.load_from_file (path, KeyFileFlags.NONE);
             string name = keyfile.get_string ("Plugin", "Name");
-
-            load_module (Path.build_filename (parent, keyfile.get_string ("Plugin", "File")), name);
+            var file_path = Path.build_filename (parent, keyfile.get_string ("Plugin", "File"));
+
+            if (keyfile.has_group ("Triggers")) {
+                if (!plugin_hash.has_key (file_path) && !lazy_plugins.has_key (file_path)) {
+                    lazy_plugins.set (file_path, new LazyPlugin (file_path, name, keyfile));
+                    if (in_available) {
+                        names.add (name);
+                    }
+                }
+            } else {
+                load_module (file_path, name);
+            }
         } catch (Error e) {
             warning ("Couldn't open the keyfile '%s': %s", path, e.message);
         }
     }
 
-    public void hook_context_menu (Gtk.Menu menu, List<Files.File> files) {
+    /* Loads the plugins waiting for @hook to be called, or for @directory to be loaded */
+    private void load_triggered_plugins (string hook, Files.File? directory = null) {
+        if (lazy_plugins.is_empty) {
+            return;
+        }
+
+        string? scheme = null;
+        string? path = null;
+        if (directory != null) {
+            scheme = directory.location.get_uri_scheme ();
+            /* Markers are not looked for in remote folders, which may be slow to query */
+            if (scheme == "file") {
+                path = directory.location.get_path ();
+            }
+        }
+
+        var triggered = new Gee.ArrayList<LazyPlugin> ();
+        foreach (var lazy in lazy_plugins.values) {
+            if (lazy.is_triggered (hook, scheme, path)) {
+                triggered.add (lazy);
+            }
+        }
+
+        foreach (var lazy in triggered) {
+            lazy_plugins.unset (lazy.file_path);
+            load_module (lazy.file_path, lazy.name);
+            var plug = plugin_hash[lazy.file_path];
+            if (plug == null) {
+                continue;
+            }
+
+            debug ("Loaded plugin '%s' when needed by %s", lazy.name, hook);
+
+            /* Catch the plugin up with what the others were given before it was loaded */
+            var window = (Gtk.Widget?) last_window.get ();
+            if (window != null) {
+                plug.interface_loaded (window);
+            }
+
+            var view = (Files.AbstractSlot?) last_view.get ();
+            var loaded_directory = (Files.File?) last_directory.get ();
+            if (hook != "directory_loaded" && window is Gtk.ApplicationWindow && view != null &&
+                loaded_directory != null) {
+
+                plug.directory_loaded ((Gtk.ApplicationWindow) window, view, loaded_directory);
+            }
+        }
+    }
+
+    public void hook_context_menu (Gtk.Menu menu, List<Files.File> files, Files.SelectionSet? selection = null) {
         foreach (var menu_item in menuitem_references) {
             menu_item.parent.remove (menu_item);
         }
 
         menuitem_references.clear ();
 
-        foreach (var plugin in plugin_hash.values) {
-            plugin.context_menu (menu, files);
+        load_triggered_plugins ("context_menu");
+        foreach (var entry in plugin_hash.entries) {
+            var start_time = get_monotonic_time ();
+            entry.value.context_menu_for_selection (menu, files, selection);
+            plugin_stats[entry.key].record ("context_menu", get_monotonic_time () - start_time);
         }
     }
 
     public void directory_loaded (Gtk.ApplicationWindow window, Files.AbstractSlot view, Files.File directory) {
-        foreach (var plugin in plugin_hash.values) {
-            plugin.directory_loaded (window, view, directory);
+        last_window.set (window);
+        last_view.set (view);
+        last_directory.set (directory);
+        load_triggered_plugins ("directory_loaded", directory);
+        foreach (var entry in plugin_hash.entries) {
+            var start_time = get_monotonic_time ();
+            entry.value.directory_loaded (window, view, directory);
+            plugin_stats[entry.key].record ("directory_loaded", get_monotonic_time () - start_time);
         }
     }
 
     public void interface_loaded (Gtk.Widget win) {
-        foreach (var plugin in plugin_hash.values) {
-            plugin.interface_loaded (win);
+        last_window.set (win);
+        foreach (var entry in plugin_hash.entries) {
+            var start_time = get_monotonic_time ();
+            entry.value.interface_loaded (win);
+            plugin_stats[entry.key].record ("interface_loaded", get_monotonic_time () - start_time);
         }
     }
 
     public void sidebar_loaded (Gtk.Widget widget) {
-        foreach (var plugin in plugin_hash.values) {
-            plugin.sidebar_loaded (widget);
+        load_triggered_plugins ("sidebar_loaded");
+        foreach (var entry in plugin_hash.entries) {
+            var start_time = get_monotonic_time ();
+            entry.value.sidebar_loaded (widget);
+            plugin_stats[entry.key].record ("sidebar_loaded", get_monotonic_time () - start_time);
         }
     }
 
     public void update_sidebar (Gtk.Widget widget) {
-        foreach (var plugin in plugin_hash.values) {
-            plugin.update_sidebar (widget);
+        load_triggered_plugins ("update_sidebar");
+        foreach (var entry in plugin_hash.entries) {
+            var start_time = get_monotonic_time ();
+            entry.value.update_sidebar (widget);
+            plugin_stats[entry.key].record ("update_sidebar", get_monotonic_time () - start_time);
         }
     }
 
+    /* Files are queued and passed to each plugin separately so that a slow plugin does not hold up the others */
     public void update_file_info (Files.File file) {
-        foreach (var plugin in plugin_hash.values) {
-            plugin.update_file_info (file);
+        load_triggered_plugins ("update_file_info");
+        foreach (var queue in file_info_queues.values) {
+            queue.pending.add (file);
+            schedule_file_info (queue);
+        }
+    }
+
+    public void update_files_info (List<Files.File> files) {
+        load_triggered_plugins ("update_file_info");
+        foreach (var queue in file_info_queues.values) {
+            foreach (unowned var file in files) {
+                queue.pending.add (file);
+            }
+
+            schedule_file_info (queue);
+        }
+    }
+
+    /* Drops the files of @folder still waiting for a plugin, e.g. a slow one, once the folder is no longer loaded */
+    public void forget_files_info (GLib.File folder) {
+        foreach (var queue in file_info_queues.values) {
+            var iter = queue.pending.iterator ();
+            while (iter.next ()) {
+                var file_folder = iter.get ().directory;
+                if (file_folder != null && file_folder.equal (folder)) {
+                    iter.remove ();
+                }
+            }
+        }
+    }
+
+    private void schedule_file_info (FileInfoQueue queue) {
+        if (queue.source_id > 0 || queue.is_dispatching || queue.pending.is_empty) {
+            return;
+        }
+
+        /* Slow plugins only get files when nothing else is waiting */
+        queue.source_id = Idle.add_full (queue.is_slow ? Priority.LOW : Priority.DEFAULT_IDLE, () => {
+            queue.source_id = 0;
+            dispatch_file_info.begin (queue);
+            return Source.REMOVE;
+        });
+    }
+
+    private async void dispatch_file_info (FileInfoQueue queue) {
+        queue.is_dispatching = true;
+        var batch = queue.take_batch ();
+        var start_time = get_monotonic_time ();
+        if (queue.plugin.thread_safe) {
+            new Thread<bool> ("plugin-file-info", () => {
+                queue.plugin.update_files_info (batch);
+                Idle.add (dispatch_file_info.callback);
+                return true;
+            });
+
+            yield;
+        } else {
+            queue.plugin.update_files_info (batch);
         }
+
+        var elapsed = get_monotonic_time () - start_time;
+        queue.stats.record ("update_files_info", elapsed, batch.length ());
+        if (elapsed <= BATCH_BUDGET_USEC) {
+            queue.slow_batches = 0;
+        } else if (++queue.slow_batches >= MAX_SLOW_BATCHES && !queue.is_slow) {
+            warning ("Plugin '%s' took %d ms to update %u files. It will be given fewer files at a time and only " +
+                     "when idle.", queue.name, (int) (elapsed / 1000), batch.length ());
+            queue.is_slow = true;
+        }
+
+        queue.is_dispatching = false;
+        schedule_file_info (queue);
     }
 
     public Gee.List<string> get_available_plugins () {
         return names;
     }
+
+    /* The hook statistics of each plugin as a(sa{s(ttxxat)}), see PluginStats.to_variant () */
+    public Variant get_stats () {
+        var builder = new VariantBuilder (new VariantType ("a(sa{s(ttxxat)})"));
+        foreach (var stats in plugin_stats.values) {
+            builder.add ("(s@a{s(ttxxat)})", stats.name, stats.to_variant ());
+        }
+
+        return builder.end ();
+    }
+
+    public string get_stats_report () {
+        var report = new StringBuilder ();
+        foreach (var stats in plugin_stats.values) {
+            report.append (stats.to_report ());
+        }
+
+        return report.str;
+    }
 }
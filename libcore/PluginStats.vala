@@ -0,0 +1,135 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* How often each hook of a plugin has been called and how long the calls took, kept as a histogram of latencies so
+ * that a plugin which is usually fast but occasionally stalls a view can be told from one that is always slow.
+ */
+public class Files.PluginStats : GLib.Object {
+    /* The upper bounds of the histogram buckets, except for the last bucket which has none */
+    public const int64[] BUCKET_LIMITS_USEC = { 100, 1000, 10000, 100000, 1000000 };
+    public const int N_BUCKETS = 6;
+
+    [Compact]
+    private class HookStats {
+        public uint64 calls = 0;
+        /* Files passed to update_files_info (), otherwise the number of calls */
+        public uint64 items = 0;
+        public int64 total_usec = 0;
+        public int64 max_usec = 0;
+        public uint64 buckets[N_BUCKETS];
+    }
+
+    public string name { get; construct; }
+
+    private GLib.HashTable<string, HookStats> hooks;
+
+    public PluginStats (string name) {
+        Object (name: name);
+    }
+
+    construct {
+        hooks = new GLib.HashTable<string, HookStats> (str_hash, str_equal);
+    }
+
+    public void record (string hook, int64 elapsed_usec, uint n_items = 1) {
+        unowned var stats = hooks.lookup (hook);
+        if (stats == null) {
+            var new_stats = new HookStats ();
+            stats = new_stats;
+            hooks.insert (hook, (owned) new_stats);
+        }
+
+        stats.calls++;
+        stats.items += n_items;
+        stats.total_usec += elapsed_usec;
+        stats.max_usec = int64.max (stats.max_usec, elapsed_usec);
+        stats.buckets[get_bucket (elapsed_usec)]++;
+    }
+
+    public static int get_bucket (int64 elapsed_usec) {
+        for (int i = 0; i < BUCKET_LIMITS_USEC.length; i++) {
+            if (elapsed_usec < BUCKET_LIMITS_USEC[i]) {
+                return i;
+            }
+        }
+
+        return N_BUCKETS - 1;
+    }
+
+    public uint64 get_calls (string hook) {
+        unowned var stats = hooks.lookup (hook);
+        return stats != null ? stats.calls : 0;
+    }
+
+    public uint64[] get_histogram (string hook) {
+        var histogram = new uint64[N_BUCKETS];
+        unowned var stats = hooks.lookup (hook);
+        if (stats != null) {
+            for (int i = 0; i < N_BUCKETS; i++) {
+                histogram[i] = stats.buckets[i];
+            }
+        }
+
+        return histogram;
+    }
+
+    /* Returns a{s(ttxxat)} mapping each hook to its calls, items, total and maximum microseconds and histogram */
+    public GLib.Variant to_variant () {
+        var builder = new GLib.VariantBuilder (new GLib.VariantType ("a{s(ttxxat)}"));
+        foreach (unowned var hook in get_sorted_hooks ()) {
+            unowned var stats = hooks.lookup (hook);
+            var histogram = new GLib.VariantBuilder (new GLib.VariantType ("at"));
+            for (int i = 0; i < N_BUCKETS; i++) {
+                histogram.add ("t", stats.buckets[i]);
+            }
+
+            builder.add ("{s(ttxx@at)}", hook, stats.calls, stats.items, stats.total_usec, stats.max_usec,
+                         histogram.end ());
+        }
+
+        return builder.end ();
+    }
+
+    /* One line per hook, for printing */
+    public string to_report () {
+        var report = new StringBuilder ();
+        foreach (unowned var hook in get_sorted_hooks ()) {
+            unowned var stats = hooks.lookup (hook);
+            report.append_printf ("%-24s %-18s calls %-8s items %-8s total %10.1f ms  max %8.1f ms ",
+                                  name, hook, stats.calls.to_string (), stats.items.to_string (),
+                                  stats.total_usec / 1000.0, stats.max_usec / 1000.0);
+
+            for (int i = 0; i < N_BUCKETS; i++) {
+                if (i < BUCKET_LIMITS_USEC.length) {
+                    report.append_printf (" <%s:", format_usec (BUCKET_LIMITS_USEC[i]));
+                } else {
+                    report.append_printf (" >=%s:", format_usec (BUCKET_LIMITS_USEC[i - 1]));
+                }
+
+                report.append (stats.buckets[i].to_string ());
+            }
+
+            report.append_c ('\n');
+        }
+
+        return report.str;
+    }
+
+    private static string format_usec (int64 usec) {
+        if (usec >= 1000000) {
+            return (usec / 1000000).to_string () + "s";
+        } else if (usec >= 1000) {
+            return (usec / 1000).to_string () + "ms";
+        } else {
+            return usec.to_string () + "us";
+        }
+    }
+
+    private GLib.List<unowned string> get_sorted_hooks () {
+        var sorted = hooks.get_keys ();
+        sorted.sort (GLib.strcmp);
+        return sorted;
+    }
+}
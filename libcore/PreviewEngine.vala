@@ -0,0 +1,219 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* Renders previews of files at the exact size they are displayed on worker threads, without waiting for the
+ * thumbnailer. Pages of PDF documents are rendered in-process with Poppler. Other media, e.g. videos, for
+ * which there is no in-process decoder use the thumbnail already generated, scaled to the requested size.
+ * Rendered previews are kept in a cache bounded by memory use and keyed by uri, modification time,
+ * page and pixel size.
+ */
+public class Files.PreviewEngine : GLib.Object {
+    private const int MAX_THREADS = 2;
+    private const size_t MAX_CACHE_BYTES = 64 * 1024 * 1024;
+    /* Larger documents are only previewed from their thumbnail, as the whole file is parsed in-process */
+    private const uint64 MAX_IN_PROCESS_FILE_SIZE = 16 * 1024 * 1024;
+    private const uint MAX_FAILED_KEYS = 1024;
+
+    private class RenderJob : GLib.Object {
+        public string key;
+        public string uri;
+        public bool is_pdf;
+        public string? thumbnail_path;
+        public int page;
+        public int pixel_size;
+        public GLib.Cancellable? cancellable;
+        public Gdk.Pixbuf? result = null;
+        public SourceFunc callback;
+
+        /* Emitted for the other callers waiting for the same preview once it has been rendered */
+        public signal void done ();
+    }
+
+    private static PreviewEngine? instance = null;
+    public static unowned PreviewEngine get_default () {
+        if (instance == null) {
+            instance = new PreviewEngine ();
+        }
+
+        return instance;
+    }
+
+    private GLib.ThreadPool<RenderJob> pool;
+    private GLib.HashTable<string, Gdk.Pixbuf> cache;
+    private GLib.HashTable<string, RenderJob> pending; // Keys being rendered
+    private GLib.GenericSet<string> failed; // Keys that could not be rendered
+    private Gee.LinkedList<string> lru; // Most recently used first
+    private size_t cache_bytes = 0;
+
+    construct {
+        cache = new GLib.HashTable<string, Gdk.Pixbuf> (str_hash, str_equal);
+        pending = new GLib.HashTable<string, RenderJob> (str_hash, str_equal);
+        failed = new GLib.GenericSet<string> (str_hash, str_equal);
+        lru = new Gee.LinkedList<string> ();
+        try {
+            pool = new GLib.ThreadPool<RenderJob>.with_owned_data ((job) => {
+                if (job.cancellable == null || !job.cancellable.is_cancelled ()) {
+                    job.result = job.is_pdf ? render_pdf_page (job) : load_thumbnail (job);
+                }
+
+                GLib.Idle.add ((owned) job.callback);
+            }, MAX_THREADS, false);
+        } catch (GLib.ThreadError e) {
+            critical ("Could not create preview threads: %s", e.message);
+        }
+    }
+
+    /* Whether a preview can be rendered without a thumbnail */
+    public static bool can_render_in_process (Files.File file) {
+        return file.is_pdf () && file.location.is_native () && file.is_readable () &&
+               file.size <= MAX_IN_PROCESS_FILE_SIZE;
+    }
+
+    public static bool can_preview (Files.File file) {
+        return can_render_in_process (file) ||
+               (file.thumbstate == Files.File.ThumbState.READY && file.thumbnail_path != null);
+    }
+
+    /* Returns a cached preview without rendering */
+    public Gdk.Pixbuf? lookup (Files.File file, int size, int scale, int page = 0) {
+        var key = get_key (file, size * scale, page);
+        var pixbuf = cache.lookup (key);
+        if (pixbuf != null) {
+            lru.remove (key);
+            lru.offer_head (key);
+        }
+
+        return pixbuf;
+    }
+
+    /* Returns a preview at most @size by @size logical pixels, or null if none can be made. Callers asking for a
+     * preview already being rendered wait for the same result. */
+    public async Gdk.Pixbuf? get_preview (Files.File file, int size, int scale, int page = 0,
+                                          GLib.Cancellable? cancellable = null) {
+        var cached = lookup (file, size, scale, page);
+        if (cached != null || !can_preview (file) || pool == null) {
+            return cached;
+        }
+
+        var key = get_key (file, size * scale, page);
+        if (key in failed) {
+            return null;
+        }
+
+        var pending_job = pending.lookup (key);
+        if (pending_job != null) {
+            var handler = pending_job.done.connect (() => {
+                GLib.Idle.add (get_preview.callback);
+            });
+
+            yield;
+            pending_job.disconnect (handler);
+            if (pending_job.result == null && pending_job.cancellable != null &&
+                pending_job.cancellable.is_cancelled () && (cancellable == null || !cancellable.is_cancelled ())) {
+
+                /* Cancelled by the caller that started it but still wanted by this one */
+                return yield get_preview (file, size, scale, page, cancellable);
+            }
+
+            return pending_job.result;
+        }
+
+        var job = new RenderJob () {
+            key = key,
+            uri = file.uri,
+            is_pdf = can_render_in_process (file),
+            thumbnail_path = file.thumbnail_path,
+            page = page,
+            pixel_size = size * scale,
+            cancellable = cancellable,
+            callback = get_preview.callback
+        };
+
+        try {
+            pool.add (job);
+        } catch (GLib.ThreadError e) {
+            warning ("Could not queue preview of %s: %s", file.uri, e.message);
+            return null;
+        }
+
+        pending.insert (key, job);
+        yield;
+        pending.remove (key);
+
+        if (job.result != null) {
+            add_to_cache (key, job.result);
+        } else if (cancellable == null || !cancellable.is_cancelled ()) {
+            if (failed.length >= MAX_FAILED_KEYS) {
+                failed.remove_all ();
+            }
+
+            failed.add (key);
+        }
+
+        job.done ();
+        return job.result;
+    }
+
+    private string get_key (Files.File file, int pixel_size, int page) {
+        return "%s:%llu:%i:%i".printf (file.uri, file.modified, page, pixel_size);
+    }
+
+    private void add_to_cache (string key, Gdk.Pixbuf pixbuf) {
+        if (cache.contains (key)) {
+            return;
+        }
+
+        cache.insert (key, pixbuf);
+        lru.offer_head (key);
+        cache_bytes += pixbuf.get_byte_length ();
+        while (cache_bytes > MAX_CACHE_BYTES && lru.size > 1) {
+            var old_key = lru.poll_tail ();
+            cache_bytes -= cache.lookup (old_key).get_byte_length ();
+            cache.remove (old_key);
+        }
+    }
+
+    /* Called on worker threads */
+    private static Gdk.Pixbuf? render_pdf_page (RenderJob job) {
+        try {
+            var doc = new Poppler.Document.from_file (job.uri, null);
+            var page = doc.get_page (job.page.clamp (0, doc.get_n_pages () - 1));
+            if (page == null) {
+                return null;
+            }
+
+            double page_width, page_height;
+            page.get_size (out page_width, out page_height);
+            var ratio = job.pixel_size / double.max (page_width, page_height);
+            var width = int.max (1, (int) (page_width * ratio));
+            var height = int.max (1, (int) (page_height * ratio));
+
+            var surface = new Cairo.ImageSurface (Cairo.Format.ARGB32, width, height);
+            var ctx = new Cairo.Context (surface);
+            ctx.set_source_rgb (1.0, 1.0, 1.0);
+            ctx.paint ();
+            ctx.scale (ratio, ratio);
+            page.render (ctx);
+
+            return Gdk.pixbuf_get_from_surface (surface, 0, 0, width, height);
+        } catch (GLib.Error e) {
+            debug ("Could not render preview of %s: %s", job.uri, e.message);
+            return null;
+        }
+    }
+
+    private static Gdk.Pixbuf? load_thumbnail (RenderJob job) {
+        if (job.thumbnail_path == null) {
+            return null;
+        }
+
+        try {
+            return new Gdk.Pixbuf.from_file_at_scale (job.thumbnail_path, job.pixel_size, job.pixel_size, true);
+        } catch (GLib.Error e) {
+            debug ("Could not load thumbnail of %s: %s", job.uri, e.message);
+            return null;
+        }
+    }
+}
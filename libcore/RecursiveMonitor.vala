@@ -0,0 +1,247 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* Watches a local folder and every folder below it, whereas a GLib.FileMonitor only exists for folders open in a
+ * view. Changes are delivered in batches so that subscribers, e.g. deep counts, can keep derived data up to date
+ * instead of rescanning on a timer. A fanotify filesystem mark is used where permitted, otherwise inotify watches
+ * are added up to a budget shared by all monitors. Monitors are shared by subscribers to the same root and must be
+ * released when no longer needed.
+ */
+public class Files.RecursiveMonitor : GLib.Object {
+    /* The files created, deleted or changed below the root since the previous batch */
+    public class ChangeSet {
+        public GLib.GenericSet<GLib.File> created;
+        public GLib.GenericSet<GLib.File> deleted;
+        public GLib.GenericSet<GLib.File> changed;
+        /* Events were lost so subscribers must rescan */
+        public bool overflow = false;
+
+        public ChangeSet () {
+            created = new GLib.GenericSet<GLib.File> (GLib.File.hash, GLib.File.equal);
+            deleted = new GLib.GenericSet<GLib.File> (GLib.File.hash, GLib.File.equal);
+            changed = new GLib.GenericSet<GLib.File> (GLib.File.hash, GLib.File.equal);
+        }
+
+        public bool is_empty () {
+            return !overflow && created.length == 0 && deleted.length == 0 && changed.length == 0;
+        }
+
+        public void add (GLib.File file, PF.RecursiveWatchEvent event) {
+            switch (event) {
+                case PF.RecursiveWatchEvent.CREATED:
+                    if (file in deleted) {
+                        deleted.remove (file);
+                        changed.add (file); // Replaced
+                    } else {
+                        created.add (file);
+                    }
+
+                    break;
+                case PF.RecursiveWatchEvent.DELETED:
+                    changed.remove (file);
+                    if (file in created) {
+                        created.remove (file);
+                    } else {
+                        deleted.add (file);
+                    }
+
+                    break;
+                case PF.RecursiveWatchEvent.CHANGED:
+                    if (!(file in created)) {
+                        changed.add (file);
+                    }
+
+                    break;
+                case PF.RecursiveWatchEvent.OVERFLOW:
+                    overflow = true;
+                    break;
+            }
+        }
+    }
+
+    private const uint BATCH_DELAY_MSEC = 200;
+    private const uint DEFAULT_MAX_WATCHES = 8192;
+    /* Folders created or moved in are watched this many at a time so a large tree does not block the main loop */
+    private const uint FOLDERS_PER_IDLE = 64;
+
+    private static GLib.HashTable<GLib.File, RecursiveMonitor>? monitors = null;
+    private static uint watches_in_use = 0;
+
+    /* Returns the monitor for @root, which must be released by the caller, or null if @root is not local */
+    public static RecursiveMonitor? get_for_root (GLib.File root) {
+        if (root.get_path () == null) {
+            return null;
+        }
+
+        if (monitors == null) {
+            monitors = new GLib.HashTable<GLib.File, RecursiveMonitor> (GLib.File.hash, GLib.File.equal);
+        }
+
+        var monitor = monitors.lookup (root);
+        if (monitor == null) {
+            monitor = new RecursiveMonitor (root);
+            monitors.insert (root, monitor);
+        }
+
+        monitor.users++;
+        return monitor;
+    }
+
+    /* Leaves most of the user limit for GLib.FileMonitor and other applications */
+    private static uint get_max_watches () {
+        try {
+            string contents;
+            GLib.FileUtils.get_contents ("/proc/sys/fs/inotify/max_user_watches", out contents);
+            return uint.min (DEFAULT_MAX_WATCHES, (uint) uint64.parse (contents.strip ()) / 4);
+        } catch (GLib.Error e) {
+            return DEFAULT_MAX_WATCHES;
+        }
+    }
+
+    public GLib.File root { get; construct; }
+    public bool is_running { get; private set; default = false; }
+    /* False if the watch budget did not cover every folder, in which case changes in the deepest folders are missed */
+    public bool is_complete { get; private set; default = false; }
+    public string backend { get; private set; default = ""; }
+
+    public signal void changed (ChangeSet changes);
+
+    private PF.RecursiveWatch? watch = null;
+    private ChangeSet pending;
+    private uint users = 0;
+    private uint n_watches = 0;
+    private uint fd_source_id = 0;
+    private uint batch_timeout_id = 0;
+    private uint add_pending_idle_id = 0;
+
+    private RecursiveMonitor (GLib.File root) {
+        Object (root: root);
+    }
+
+    construct {
+        pending = new ChangeSet ();
+        start.begin ();
+    }
+
+    public void release () {
+        if (users == 0 || --users > 0) {
+            return;
+        }
+
+        stop ();
+        monitors.remove (root);
+    }
+
+    private async void start () {
+        var path = root.get_path ();
+        /* Reserve the budget now in case other monitors start meanwhile */
+        var max_watches = get_max_watches ();
+        var budget = watches_in_use < max_watches ? max_watches - watches_in_use : 0;
+        watches_in_use += budget;
+
+        /* Adding inotify watches walks the whole tree */
+        PF.RecursiveWatch? new_watch = null;
+        new GLib.Thread<bool> ("recursive-monitor", () => {
+            new_watch = PF.RecursiveWatch.create (path, budget);
+            GLib.Idle.add (start.callback);
+            return true;
+        });
+
+        yield;
+
+        watches_in_use -= budget;
+        if (new_watch == null) {
+            debug ("Could not watch %s recursively", path);
+            return;
+        }
+
+        watch = (owned) new_watch;
+        update_watch_count ();
+        backend = watch.get_backend ();
+        if (users == 0) {
+            stop (); // Released while starting
+            return;
+        }
+
+        is_running = true;
+        fd_source_id = GLib.Unix.fd_add (watch.get_fd (), GLib.IOCondition.IN, (fd, condition) => dispatch ());
+    }
+
+    private void stop () {
+        if (fd_source_id > 0) {
+            GLib.Source.remove (fd_source_id);
+            fd_source_id = 0;
+        }
+
+        if (batch_timeout_id > 0) {
+            GLib.Source.remove (batch_timeout_id);
+            batch_timeout_id = 0;
+        }
+
+        if (add_pending_idle_id > 0) {
+            GLib.Source.remove (add_pending_idle_id);
+            add_pending_idle_id = 0;
+        }
+
+        watches_in_use -= n_watches;
+        n_watches = 0;
+        watch = null;
+        is_running = false;
+    }
+
+    private void update_watch_count () {
+        var count = watch.get_n_watches ();
+        watches_in_use = watches_in_use - n_watches + count;
+        n_watches = count;
+        is_complete = watch.is_complete ();
+    }
+
+    private bool dispatch () {
+        var still_running = watch.dispatch ((path, event) => {
+            pending.add (GLib.File.new_for_path (path), event);
+        });
+
+        if (!still_running) {
+            /* The root has been deleted */
+            fd_source_id = 0;
+            emit_changes ();
+            stop ();
+            return GLib.Source.REMOVE;
+        }
+
+        add_pending ();
+        if (batch_timeout_id == 0 && !pending.is_empty ()) {
+            batch_timeout_id = GLib.Timeout.add (BATCH_DELAY_MSEC, () => {
+                batch_timeout_id = 0;
+                emit_changes ();
+                return GLib.Source.REMOVE;
+            });
+        }
+
+        return GLib.Source.CONTINUE;
+    }
+
+    private void add_pending () {
+        var more = watch.add_pending (FOLDERS_PER_IDLE);
+        update_watch_count ();
+        if (more && add_pending_idle_id == 0) {
+            add_pending_idle_id = GLib.Idle.add_full (GLib.Priority.LOW, () => {
+                add_pending_idle_id = 0;
+                add_pending ();
+                return GLib.Source.REMOVE;
+            });
+        }
+    }
+
+    private void emit_changes () {
+        if (pending.is_empty ()) {
+            return;
+        }
+
+        var changes = pending;
+        pending = new ChangeSet ();
+        changed (changes);
+    }
+}
@@ -0,0 +1,180 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* The files selected in a view with totals for the status bar and the content types selected. When the selection
+ * changes the totals are only adjusted for the files added or removed, so a large selection is not rescanned, nor the
+ * size of each of its files queried again, whenever a file is added to it.
+ */
+public class Files.SelectionSet : GLib.Object {
+    public delegate uint64 SizeFunc (Files.File file);
+
+    /* What was counted for a file when it was added, so that removing it reverses exactly that */
+    [Compact]
+    private class Entry {
+        public bool is_folder;
+        public uint64 size;
+        public string? content_type;
+        public uint generation;
+    }
+
+    public uint count {
+        get {
+            return entries.size ();
+        }
+    }
+
+    public uint folders_count { get; private set; default = 0; }
+    public uint files_count { get; private set; default = 0; }
+    /* The total size of the files that are not folders */
+    public uint64 total_size { get; private set; default = 0; }
+
+    private GLib.HashTable<Files.File, Entry> entries;
+    /* The number of selected files of each content type */
+    private GLib.HashTable<string, uint> content_types;
+    private string[]? sorted_content_types = null;
+    private SizeFunc size_func;
+    private uint generation = 0;
+
+    public SelectionSet (owned SizeFunc? size_func = null) {
+        if (size_func != null) {
+            this.size_func = (owned) size_func;
+        } else {
+            this.size_func = (file) => file.size;
+        }
+    }
+
+    construct {
+        entries = new GLib.HashTable<Files.File, Entry> (direct_hash, direct_equal);
+        content_types = new GLib.HashTable<string, uint> (str_hash, str_equal);
+    }
+
+    public bool contains (Files.File file) {
+        return file in entries;
+    }
+
+    /* Returns false if @file was already selected */
+    public bool add (Files.File file) {
+        if (file in entries) {
+            return false;
+        }
+
+        var new_entry = new Entry () {
+            is_folder = file.is_folder (),
+            content_type = file.content_type,
+            generation = generation
+        };
+
+        if (new_entry.content_type != null) {
+            var n_files = content_types.lookup (new_entry.content_type);
+            if (n_files == 0) {
+                sorted_content_types = null;
+            }
+
+            content_types.insert (new_entry.content_type, n_files + 1);
+        }
+
+        if (new_entry.is_folder) {
+            folders_count++;
+        } else {
+            new_entry.size = size_func (file);
+            files_count++;
+            total_size += new_entry.size;
+        }
+
+        entries.insert (file, (owned) new_entry);
+        return true;
+    }
+
+    /* Returns false if @file was not selected */
+    public bool remove (Files.File file) {
+        unowned var entry = entries.lookup (file);
+        if (entry == null) {
+            return false;
+        }
+
+        subtract (entry);
+        entries.remove (file);
+        return true;
+    }
+
+    public void clear () {
+        entries.remove_all ();
+        content_types.remove_all ();
+        sorted_content_types = null;
+        folders_count = 0;
+        files_count = 0;
+        total_size = 0;
+    }
+
+    /* Makes the set hold exactly @files. Only files that were not already selected are counted and only those no
+     * longer selected are subtracted. Returns false if the selection did not change. */
+    public bool update (GLib.List<Files.File> files) {
+        generation++;
+        bool changed = false;
+        uint n_marked = 0;
+        foreach (unowned var file in files) {
+            unowned var entry = entries.lookup (file);
+            if (entry == null) {
+                add (file);
+                changed = true;
+                n_marked++;
+            } else if (entry.generation != generation) {
+                entry.generation = generation;
+                n_marked++;
+            }
+        }
+
+        if (entries.size () > n_marked) {
+            /* Some selected files were not in the list */
+            entries.foreach_remove ((key, entry) => {
+                if (entry.generation != generation) {
+                    subtract (entry);
+                    return true;
+                }
+
+                return false;
+            });
+
+            changed = true;
+        }
+
+        return changed;
+    }
+
+    /* The distinct content types of the selected files, sorted so that equal sets of types compare equal */
+    public string[] get_content_types () {
+        if (sorted_content_types == null) {
+            var types = content_types.get_keys ();
+            types.sort (GLib.strcmp);
+            string[] sorted = {};
+            foreach (unowned var type in types) {
+                sorted += type;
+            }
+
+            sorted_content_types = (owned) sorted;
+        }
+
+        return sorted_content_types;
+    }
+
+    private void subtract (Entry entry) {
+        if (entry.content_type != null) {
+            var n_files = content_types.lookup (entry.content_type);
+            if (n_files <= 1) {
+                content_types.remove (entry.content_type);
+                sorted_content_types = null;
+            } else {
+                content_types.insert (entry.content_type, n_files - 1);
+            }
+        }
+
+        if (entry.is_folder) {
+            folders_count--;
+        } else {
+            files_count--;
+            total_size -= entry.size;
+        }
+    }
+}
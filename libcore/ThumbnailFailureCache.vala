@@ -0,0 +1,169 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* Remembers files that the thumbnailer failed to thumbnail so that they are not requested again when
+ * their folder is revisited, even after a restart. An entry only matches while the modification time and
+ * content type of the file are unchanged. The cache is kept with the fail thumbnails in the user cache dir.
+ * Entries are forgotten after a while, so files are retried now and then, and the oldest are forgotten when
+ * there are too many.
+ */
+public class Files.ThumbnailFailureCache : GLib.Object {
+    private const string GROUP = "Failures";
+    /* Failures usually come in bursts while thumbnailing a folder, so one save covers many of them */
+    private const uint SAVE_DELAY_MSEC = 10000;
+    private const int MAX_AGE_DAYS = 30;
+    private const int64 SECONDS_PER_DAY = 24 * 3600;
+    private const uint MAX_FAILURES = 20000;
+
+    [Compact]
+    private class Failure {
+        public string file_state; // mtime;content type
+        public int64 recorded; // Seconds since the epoch
+
+        public Failure (string file_state, int64 recorded) {
+            this.file_state = file_state;
+            this.recorded = recorded;
+        }
+    }
+
+    private static ThumbnailFailureCache? instance = null;
+    public static unowned ThumbnailFailureCache get_default () {
+        if (instance == null) {
+            instance = new ThumbnailFailureCache ();
+        }
+
+        return instance;
+    }
+
+    private GLib.HashTable<string, Failure> failures; // Keys are uri hashes
+    private string cache_path;
+    private uint save_timeout_id = 0;
+
+    construct {
+        failures = new GLib.HashTable<string, Failure> (str_hash, str_equal);
+        cache_path = GLib.Path.build_filename (
+            GLib.Environment.get_user_cache_dir (), "thumbnails", "fail", Files.APP_ID, "failures"
+        );
+
+        var keyfile = new GLib.KeyFile ();
+        try {
+            keyfile.load_from_file (cache_path, GLib.KeyFileFlags.NONE);
+            var now = get_now ();
+            foreach (unowned string key in keyfile.get_keys (GROUP)) {
+                /* Values are mtime;content type;time recorded */
+                var val = keyfile.get_string (GROUP, key);
+                var separator = val.last_index_of_char (';');
+                int64 recorded;
+                if (separator > 0 && int64.try_parse (val.substring (separator + 1), out recorded) &&
+                    now - recorded < MAX_AGE_DAYS * SECONDS_PER_DAY) {
+
+                    failures.insert (key, new Failure (val.substring (0, separator), recorded));
+                }
+            }
+
+            if (failures.size () > MAX_FAILURES) {
+                forget_oldest ();
+            }
+        } catch (GLib.FileError.NOENT e) {
+            /* Nothing has failed yet */
+        } catch (GLib.Error e) {
+            warning ("Could not load thumbnail failures from %s: %s", cache_path, e.message);
+        }
+    }
+
+    public bool has_failed (Files.File file) {
+        return has_failed_uri (file.uri, file.modified, file.content_type);
+    }
+
+    public bool has_failed_uri (string uri, uint64 modified, string? content_type) {
+        unowned var failure = failures.lookup (get_key (uri));
+        return failure != null && failure.file_state == get_file_state (modified, content_type);
+    }
+
+    public void add (Files.File file) {
+        add_uri (file.uri, file.modified, file.content_type);
+    }
+
+    public void add_uri (string uri, uint64 modified, string? content_type) {
+        if (modified == 0) {
+            return; // Cannot tell whether the file changes later
+        }
+
+        if (failures.size () >= MAX_FAILURES) {
+            forget_oldest ();
+        }
+
+        failures.insert (get_key (uri), new Failure (get_file_state (modified, content_type), get_now ()));
+
+        schedule_save ();
+    }
+
+    public void remove (string uri) {
+        if (failures.remove (get_key (uri))) {
+            schedule_save ();
+        }
+    }
+
+    private string get_key (string uri) {
+        return GLib.Checksum.compute_for_string (GLib.ChecksumType.MD5, uri);
+    }
+
+    private string get_file_state (uint64 modified, string? content_type) {
+        return "%llu;%s".printf (modified, content_type ?? "");
+    }
+
+    private static int64 get_now () {
+        return GLib.get_real_time () / 1000000;
+    }
+
+    private static int get_age_days (Failure failure, int64 now) {
+        return (int) ((now - failure.recorded) / SECONDS_PER_DAY).clamp (0, MAX_AGE_DAYS);
+    }
+
+    /* Forgets whole days of failures, oldest first, until at least half of them are forgotten */
+    private void forget_oldest () {
+        var now = get_now ();
+        var day_counts = new uint[MAX_AGE_DAYS + 1];
+        failures.foreach ((key, failure) => {
+            day_counts[get_age_days (failure, now)]++;
+        });
+
+        var min_age = MAX_AGE_DAYS + 1;
+        uint n_forgotten = 0;
+        while (min_age > 0 && n_forgotten < failures.size () / 2) {
+            min_age--;
+            n_forgotten += day_counts[min_age];
+        }
+
+        failures.foreach_remove ((key, failure) => get_age_days (failure, now) >= min_age);
+        schedule_save ();
+    }
+
+    private void schedule_save () {
+        if (save_timeout_id > 0) {
+            return;
+        }
+
+        save_timeout_id = GLib.Timeout.add (SAVE_DELAY_MSEC, () => {
+            save_timeout_id = 0;
+            save ();
+            return GLib.Source.REMOVE;
+        });
+    }
+
+    private void save () {
+        var keyfile = new GLib.KeyFile ();
+        failures.foreach ((key, failure) => {
+            keyfile.set_string (GROUP, key, "%s;%lld".printf (failure.file_state, failure.recorded));
+        });
+
+        try {
+            GLib.DirUtils.create_with_parents (GLib.Path.get_dirname (cache_path), 0700);
+            keyfile.save_to_file (cache_path);
+        } catch (GLib.Error e) {
+            warning ("Could not save thumbnail failures to %s: %s", cache_path, e.message);
+        }
+    }
+}
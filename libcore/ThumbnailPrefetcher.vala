@@ -0,0 +1,255 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* Thumbnails are normally only requested for files visible in a view so folders that are likely to be opened
+ * next always start cold. When Files has been left alone for a while and the computer is on AC power, this asks
+ * the thumbnailer in the background for the missing thumbnails of bookmarked folders, folders that will be
+ * restored as tabs and folders recently visited. Folders are processed one at a time and any user activity
+ * suspends prefetching until the next quiet period.
+ */
+public class Files.ThumbnailPrefetcher : GLib.Object {
+    [DBus (name = "org.freedesktop.UPower")]
+    private interface UPower : GLib.DBusProxy {
+        public abstract bool on_battery { get; }
+    }
+
+    private const uint QUIET_PERIOD_SEC = 30;
+    private const uint MAX_FILES_PER_FOLDER = 256;
+    private const uint MAX_HISTORY_FOLDERS = 32;
+    private const string ATTRIBUTES = "standard::name,standard::type,standard::content-type,time::modified," +
+                                      "thumbnail::path,thumbnail::is-valid,thumbnail::failed";
+
+    private static ThumbnailPrefetcher? instance = null;
+    public static unowned ThumbnailPrefetcher get_default () {
+        if (instance == null) {
+            instance = new ThumbnailPrefetcher ();
+        }
+
+        return instance;
+    }
+
+    private Gee.LinkedList<GLib.File> history;
+    private GLib.HashTable<string, uint64?> prefetched; // Folder uri to folder mtime when last prefetched
+    private GLib.Settings app_settings;
+    private UPower? upower = null;
+    private GLib.Cancellable? cancellable = null;
+    private uint quiet_timeout_id = 0;
+    private int pending_request = -1;
+    /* The folder of the pending request, recorded as prefetched once the request has finished without error */
+    private string? pending_uri = null;
+    private uint64 pending_mtime = 0;
+    private bool pending_failed = false;
+    /* Folders whose request failed are not requested again until the next quiet period, e.g. while the thumbnailer
+     * is not running */
+    private GLib.GenericSet<string> failed_this_pass;
+
+    construct {
+        history = new Gee.LinkedList<GLib.File> ((a, b) => a.equal (b));
+        prefetched = new GLib.HashTable<string, uint64?> (str_hash, str_equal);
+        failed_this_pass = new GLib.GenericSet<string> (str_hash, str_equal);
+        app_settings = new GLib.Settings ("io.elementary.files.preferences");
+
+        GLib.Bus.get_proxy.begin<UPower> (
+            GLib.BusType.SYSTEM,
+            "org.freedesktop.UPower",
+            "/org/freedesktop/UPower",
+            GLib.DBusProxyFlags.DO_NOT_AUTO_START,
+            null,
+            (obj, res) => {
+                try {
+                    upower = GLib.Bus.get_proxy.end (res);
+                } catch (GLib.Error e) {
+                    debug ("UPower not available, assuming AC power: %s", e.message);
+                }
+            }
+        );
+
+        Thumbnailer.@get ().finished.connect ((request) => {
+            if (request == pending_request) {
+                pending_request = -1;
+                if (pending_failed) {
+                    failed_this_pass.add (pending_uri);
+                } else {
+                    prefetched.insert (pending_uri, pending_mtime);
+                }
+
+                prefetch_next_folder.begin ();
+            }
+        });
+
+        BookmarkList.get_instance ().contents_changed.connect (notify_activity);
+        notify_activity ();
+    }
+
+    /* Records a visited folder as a candidate for prefetching */
+    public void add_visited_folder (GLib.File folder) {
+        if (!folder.is_native ()) {
+            return;
+        }
+
+        history.remove (folder);
+        history.insert (0, folder);
+        if (history.size > MAX_HISTORY_FOLDERS) {
+            history.remove_at (history.size - 1);
+        }
+
+        notify_activity ();
+    }
+
+    /* Suspends prefetching until there has been no activity for a while */
+    public void notify_activity () {
+        if (cancellable != null) {
+            cancellable.cancel ();
+            cancellable = null;
+        }
+
+        if (pending_request >= 0) {
+            Thumbnailer.@get ().dequeue (pending_request);
+            pending_request = -1;
+        }
+
+        if (quiet_timeout_id > 0) {
+            GLib.Source.remove (quiet_timeout_id);
+        }
+
+        quiet_timeout_id = GLib.Timeout.add_seconds_full (GLib.Priority.LOW, QUIET_PERIOD_SEC, () => {
+            quiet_timeout_id = 0;
+            if (upower != null && upower.on_battery) {
+                return GLib.Source.REMOVE;
+            }
+
+            cancellable = new GLib.Cancellable ();
+            failed_this_pass.remove_all ();
+            prefetch_next_folder.begin ();
+            return GLib.Source.REMOVE;
+        });
+    }
+
+    private GLib.List<GLib.File> get_candidate_folders () {
+        var folders = new GLib.List<GLib.File> ();
+        foreach (unowned var bookmark in BookmarkList.get_instance ().list) {
+            folders.append (bookmark.get_location ());
+        }
+
+        /* Folders that will be opened when tabs are restored on the next start */
+        if (app_settings.get_boolean ("restore-tabs") && Files.Preferences.get_default ().remember_history) {
+            var iter = new GLib.VariantIter (app_settings.get_value ("tab-info-list"));
+            uint mode;
+            string? root_uri = null;
+            string? tip_uri = null;
+            while (iter.next ("(uss)", out mode, out root_uri, out tip_uri)) {
+                if (root_uri != null && root_uri != "") {
+                    folders.append (GLib.File.new_for_uri (tip_uri != null && tip_uri != "" ? tip_uri : root_uri));
+                }
+            }
+        }
+
+        foreach (var folder in history) {
+            folders.append (folder);
+        }
+
+        return folders;
+    }
+
+    private async void prefetch_next_folder () {
+        var this_cancellable = cancellable;
+        if (this_cancellable == null || !app_settings.get_boolean ("show-local-thumbnails")) {
+            return;
+        }
+
+        foreach (var folder in get_candidate_folders ()) {
+            if (this_cancellable.is_cancelled ()) {
+                return;
+            }
+
+            if (!folder.is_native ()) {
+                continue;
+            }
+
+            uint64 mtime;
+            try {
+                var info = yield folder.query_info_async (
+                    GLib.FileAttribute.TIME_MODIFIED, GLib.FileQueryInfoFlags.NONE,
+                    GLib.Priority.LOW, this_cancellable
+                );
+                mtime = info.get_attribute_uint64 (GLib.FileAttribute.TIME_MODIFIED);
+            } catch (GLib.Error e) {
+                continue;
+            }
+
+            var uri = folder.get_uri ();
+            if (uri in failed_this_pass) {
+                continue;
+            }
+
+            var last_mtime = prefetched.lookup (uri);
+            if (last_mtime != null && (uint64) last_mtime == mtime) {
+                continue;
+            }
+
+            var infos = yield get_unthumbnailed_files (folder, this_cancellable);
+            if (infos == null || this_cancellable.is_cancelled ()) {
+                continue;
+            }
+
+            int request;
+            var queued = Thumbnailer.@get ().queue_background (folder, infos, out request, () => {
+                if (pending_uri == uri) {
+                    pending_failed = true;
+                }
+            });
+
+            if (queued) {
+                /* Continue with the next folder when this request has finished */
+                pending_request = request;
+                pending_uri = uri;
+                pending_mtime = mtime;
+                pending_failed = false;
+                return;
+            }
+
+            /* Nothing in the folder needs a thumbnail */
+            prefetched.insert (uri, mtime);
+        }
+    }
+
+    private async GLib.List<GLib.FileInfo>? get_unthumbnailed_files (GLib.File folder, GLib.Cancellable cancellable) {
+        var infos = new GLib.List<GLib.FileInfo> ();
+        uint count = 0;
+        try {
+            var enumerator = yield folder.enumerate_children_async (
+                ATTRIBUTES, GLib.FileQueryInfoFlags.NONE, GLib.Priority.LOW, cancellable
+            );
+
+            while (count < MAX_FILES_PER_FOLDER) {
+                var batch = yield enumerator.next_files_async (64, GLib.Priority.LOW, cancellable);
+                if (batch == null) {
+                    break;
+                }
+
+                foreach (var info in batch) {
+                    if (info.get_file_type () != GLib.FileType.REGULAR ||
+                        info.get_attribute_boolean (GLib.FileAttribute.THUMBNAILING_FAILED) ||
+                        (info.has_attribute (GLib.FileAttribute.THUMBNAIL_PATH) &&
+                         info.get_attribute_boolean (GLib.FileAttribute.THUMBNAIL_IS_VALID))) {
+
+                        continue;
+                    }
+
+                    infos.prepend (info);
+                    if (++count >= MAX_FILES_PER_FOLDER) {
+                        break;
+                    }
+                }
+            }
+        } catch (GLib.Error e) {
+            debug ("Could not list %s for thumbnail prefetch: %s", folder.get_uri (), e.message);
+            return null;
+        }
+
+        infos.reverse ();
+        return infos;
+    }
+}
@@ -57,6 +57,9 @@
  * The Ready and Error signal handlers work exactly like Started except that
  * the Ready idle function sets the thumb state of the corresponding
  * GOFFile objects to _READY and the Error signal sets the state to _NONE.
+ * Errors that will recur for an unchanged file are recorded in the
+ * ThumbnailFailureCache, which queue_files consults so that such files are
+ * not sent to the thumbnailer again.
  *
  *
  * Finished
@@ -84,6 +87,7 @@ namespace Files {
     }
 
     public class Thumbnailer : GLib.Object {
+        public delegate void ErrorFunc ();
 
         enum IdleType {
             ERROR,
@@ -92,15 +96,30 @@ namespace Files {
             FINISHED
         }
 
+        /* The codes of the Error signal, as defined by the thumbnail management D-Bus specification */
+        enum ErrorCode {
+            UNSUPPORTED_MIME_TYPE = 0, // No thumbnailer handles the type of the file
+            CONNECTION_FAILED = 1, // The file could not be read, e.g. a remote file that is unreachable
+            INVALID_DATA = 2, // The content of the file is corrupt or not of its type
+            IS_THUMBNAIL = 3, // The file is itself a thumbnail
+            SAVE_FAILED = 4, // The thumbnail could not be written
+            UNSUPPORTED_FLAVOR = 5 // The thumbnail size requested is not supported
+        }
+
         struct Idle {
             uint id;
             IdleType type;
             string[] uris;
             uint handle;
+            int error_code;
         }
 
         struct UriList {
             string[] uris;
+            /* Only set for background requests, which have no Files.File to update */
+            string[] mime_types;
+            uint64[] modified;
+            bool background;
         }
 
 
@@ -185,8 +204,12 @@ namespace Files {
             GLib.List<Files.File> supported_files = null;
 
             uint file_count = 0;
+            unowned var failure_cache = ThumbnailFailureCache.get_default ();
             foreach (var file in files) {
-                if (is_supported (file)) {
+                if (failure_cache.has_failed (file)) {
+                    /* Already known to fail - do not ask again */
+                    file.thumbstate = Files.File.ThumbState.NONE;
+                } else if (is_supported (file)) {
                     supported_files.prepend (file);
                     file.thumbstate = Files.File.ThumbState.LOADING;
                     file_count++;
@@ -211,9 +234,72 @@ namespace Files {
                 index++;
             }
 
+            var uri_list = UriList () {
+                uris = uris,
+                background = false
+            };
+
+            request = (int) send_request (uri_list, mime_hints, "foreground", () => {
+                foreach (var file in files) {
+                    // Do not leave in LOADING state
+                    file.thumbstate = Files.File.ThumbState.NONE;
+                    file.update_icon ();
+                }
+            });
+
+            return true;
+        }
+
+        /* Requests thumbnails for files of @dir that are not displayed, e.g. to prefetch them. The thumbnailer's
+         * background scheduler is used and no Files.File objects are created or updated. @infos must contain the
+         * name, content type and modification time of each file. @on_error is called before finished is emitted if
+         * the request could not be sent. */
+        public bool queue_background (GLib.File dir, GLib.List<GLib.FileInfo> infos, out int request,
+                                      owned ErrorFunc? on_error = null) {
+            request = -1;
+            if (proxy == null) {
+                return false;
+            }
+
+            string[] uris = {};
+            string[] mime_hints = {};
+            uint64[] modified = {};
+            unowned var failure_cache = ThumbnailFailureCache.get_default ();
+            foreach (unowned var info in infos) {
+                var location = dir.get_child (info.get_name ());
+                var uri = location.get_uri ();
+                var content_type = info.get_content_type ();
+                var mtime = info.get_attribute_uint64 (GLib.FileAttribute.TIME_MODIFIED);
+                if (content_type == null ||
+                    failure_cache.has_failed_uri (uri, mtime, content_type) ||
+                    !is_supported_type (location, content_type)) {
+
+                    continue;
+                }
+
+                uris += uri;
+                mime_hints += content_type;
+                modified += mtime;
+            }
+
+            if (uris.length == 0) {
+                return false;
+            }
+
+            var uri_list = UriList () {
+                uris = uris,
+                mime_types = mime_hints,
+                modified = modified,
+                background = true
+            };
+
+            request = (int) send_request (uri_list, mime_hints, "background", (owned) on_error);
+            return true;
+        }
+
+        private uint send_request (UriList uri_list, string[] mime_hints, string scheduler, owned ErrorFunc? on_error) {
             uint this_request = ++last_request;
-            var scheduler = "foreground";
-            proxy.queue.begin (uris, mime_hints, "large", scheduler, 0, (obj, res) => {
+            proxy.queue.begin (uri_list.uris, mime_hints, "large", scheduler, 0, (obj, res) => {
                 try {
                     uint handle;
                     handle = proxy.queue.end (res);
@@ -221,22 +307,18 @@ namespace Files {
                     handle_request_mapping.insert (handle, this_request);
                     // Save uris requested so we can check if any ignored (neither ready nor in error) when request finiahed.
                     // Arrays are not supported in HashTables so put into a boxed struct.
-                    var uri_list = UriList () {
-                        uris = uris
-                    };
                     handle_uris_mapping.insert (handle, uri_list);
                 } catch (GLib.Error e) {
                     debug ("Thumbnailer proxy request %u failed: %s", this_request, e.message);
-                    foreach (var file in files) {
-                        // Do not leave in LOADING state
-                        file.thumbstate = Files.File.ThumbState.NONE;
-                        file.update_icon ();
+                    if (on_error != null) {
+                        on_error ();
                     }
+
+                    finished (this_request);
                 }
             });
 
-            request = (int)this_request;
-            return true;
+            return this_request;
         }
 
         public void dequeue (int request) {
@@ -254,9 +336,12 @@ namespace Files {
         }
 
         private bool is_supported (Files.File file) {
+            return file.content_type != null && is_supported_type (file.location, file.content_type);
+        }
+
+        private bool is_supported_type (GLib.File location, string ftype) {
             /* TODO cache supported combinations */
-            var ftype = file.content_type;
-            if (proxy == null || ftype == null) {
+            if (proxy == null) {
                 return false;
             }
 
@@ -273,7 +358,7 @@ namespace Files {
             if (supported_schemes != null && supported_types != null) {
                 uint index = 0;
                 foreach (string scheme in supported_schemes) {
-                    if (file.location.has_uri_scheme (scheme) &&
+                    if (location.has_uri_scheme (scheme) &&
                        GLib.ContentType.is_a (ftype, supported_types[index])) {
                         supported = true;
                         break;
@@ -293,6 +378,8 @@ namespace Files {
             var idle = Idle ();
             idle.type = IdleType.ERROR;
             idle.uris = GLib.strdupv (failed_uris);
+            idle.error_code = error_code;
+            idle.handle = handle;
             idles.prepend (idle);
 
             /* TODO batch up errors? */
@@ -340,8 +427,34 @@ namespace Files {
         }
 
         private static void handle_error_idle (Idle error_idle) {
+            /* Only remember failures that will recur while the file is unchanged */
+            var persistent = error_idle.error_code == ErrorCode.UNSUPPORTED_MIME_TYPE ||
+                             error_idle.error_code == ErrorCode.INVALID_DATA ||
+                             error_idle.error_code == ErrorCode.IS_THUMBNAIL;
+            unowned var uri_list = handle_uris_mapping.lookup (error_idle.handle);
             foreach (string uri in error_idle.uris) {
+                if (uri_list != null && uri_list.background) {
+                    if (persistent) {
+                        for (int i = 0; i < uri_list.uris.length; i++) {
+                            if (uri_list.uris[i] == uri) {
+                                ThumbnailFailureCache.get_default ().add_uri (
+                                    uri, uri_list.modified[i], uri_list.mime_types[i]
+                                );
+                                break;
+                            }
+                        }
+                    }
+
+                    continue;
+                }
+
                 update_file_thumbstate (uri, Files.File.ThumbState.NONE);
+                if (persistent) {
+                    var goffile = Files.File.get_by_uri (uri);
+                    if (goffile != null) {
+                        ThumbnailFailureCache.get_default ().add (goffile);
+                    }
+                }
             }
 
             thumbnailer_lock.@lock ();
@@ -350,8 +463,14 @@ namespace Files {
         }
 
         private static void handle_ready_idle (Idle ready_idle) {
+            unowned var uri_list = handle_uris_mapping.lookup (ready_idle.handle);
+            var background = uri_list != null && uri_list.background;
             foreach (string uri in ready_idle.uris) {
-                update_file_thumbstate (uri, Files.File.ThumbState.READY);
+                if (!background) {
+                    update_file_thumbstate (uri, Files.File.ThumbState.READY);
+                }
+
+                ThumbnailFailureCache.get_default ().remove (uri);
             }
 
             thumbnailer_lock.@lock ();
@@ -362,11 +481,13 @@ namespace Files {
         private static void handle_finished_idle (Idle finished_idle) {
             var handle = finished_idle.handle;
             unowned var uri_list = handle_uris_mapping.lookup (handle);
-            foreach (var uri in uri_list.uris) {
-                var goffile = Files.File.get_by_uri (uri);
-                if (goffile.thumbstate == Files.File.ThumbState.LOADING) {
-                    goffile.thumbstate = Files.File.ThumbState.NONE;
-                    goffile.update_icon ();
+            if (uri_list != null && !uri_list.background) {
+                foreach (var uri in uri_list.uris) {
+                    var goffile = Files.File.get_by_uri (uri);
+                    if (goffile.thumbstate == Files.File.ThumbState.LOADING) {
+                        goffile.thumbstate = Files.File.ThumbState.NONE;
+                        goffile.update_icon ();
+                    }
                 }
             }
 
@@ -374,6 +495,7 @@ namespace Files {
             uint request = handle_request_mapping.lookup (handle);
             request_handle_mapping.remove (request);
             handle_request_mapping.remove (handle);
+            handle_uris_mapping.remove (handle);
             thumbnailer_lock.unlock ();
             Thumbnailer.@get ().finished (request);
         }
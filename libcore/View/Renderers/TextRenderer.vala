@@ -68,7 +68,25 @@ namespace Files {
 
         int char_height;
 
-        Pango.Layout layout;
+        /* Measuring and wrapping names is expensive so layouts are cached, keyed by text, width and zoom.
+         * The cache is cleared when the widget or its style (and so the font) changes. Only the sizes of
+         * layouts are kept for every name; the layouts themselves are kept for a limited number of names. */
+        const uint MAX_CACHED_LAYOUTS = 1024;
+        const uint MAX_CACHED_SIZES = 65536;
+
+        [Compact]
+        private class CachedLayout {
+            public Pango.Layout? layout = null;
+            public int width;
+            public int height;
+            public bool measured = false;
+        }
+
+        private GLib.HashTable<string, CachedLayout> layout_cache;
+        private uint n_cached_layouts = 0;
+
+        Pango.Layout layout; /* Template for cached layouts */
+        unowned Pango.Layout? render_layout = null;
         Gtk.Widget widget;
         AbstractEditableLabel entry;
 
@@ -77,6 +95,7 @@ namespace Files {
             text_css = new Gtk.CssProvider ();
             previous_background_rgba = { 0, 0, 0, 0 };
             previous_contrasting_rgba = { 0, 0, 0, 0 };
+            layout_cache = new GLib.HashTable<string, CachedLayout> (str_hash, str_equal);
         }
 
         public TextRenderer (ViewMode viewmode) {
@@ -97,7 +116,7 @@ namespace Files {
         public override void get_preferred_height_for_width (Gtk.Widget widget, int width,
                                                                out int minimum_size, out int natural_size) {
             set_widget (widget);
-            set_up_layout (text, width);
+            set_up_layout (text, width, false);
             natural_size = text_height + 4 * border_radius;
             minimum_size = natural_size;
         }
@@ -167,7 +186,7 @@ namespace Files {
             style_context.render_layout (cr,
                                          cell_area.x + text_x_offset,
                                          cell_area.y + text_y_offset,
-                                         layout);
+                                         render_layout);
 
             style_context.restore (); /* NOTE: This does not remove added classes */
             style_context.remove_provider (text_css); /* No error if provider not added */
@@ -179,33 +198,66 @@ namespace Files {
             file = null;
         }
 
-        public void set_up_layout (string? text, int cell_width) {
+        public void set_up_layout (string? text, int cell_width, bool for_render = true) {
             if (text == null) {
                 text= " ";
             }
 
-            if (is_list_view) {
-                layout.set_width ((cell_width - double_border_radius) * Pango.SCALE);
-                layout.set_height (- 1);
-            } else {
-                layout.set_width (wrap_width * Pango.SCALE);
-                layout.set_wrap (this.wrap_mode);
-                layout.set_height (- MAX_LINES);
+            int layout_width = is_list_view ? cell_width - double_border_radius : wrap_width;
+            var key = "%i:%i:%s".printf (layout_width, (int) zoom_level, text);
+            unowned CachedLayout? cached = layout_cache.lookup (key);
+            if (cached == null) {
+                if (layout_cache.size () >= MAX_CACHED_SIZES) {
+                    clear_layout_cache ();
+                }
+
+                var new_cached = new CachedLayout ();
+                cached = new_cached;
+                layout_cache.insert (key, (owned) new_cached);
             }
 
-            layout.set_ellipsize (Pango.EllipsizeMode.END);
+            if (cached.layout == null && (for_render || !cached.measured)) {
+                if (n_cached_layouts >= MAX_CACHED_LAYOUTS) {
+                    layout_cache.foreach ((k, v) => {
+                        v.layout = null;
+                    });
 
-            if (!is_list_view) {
-                layout.set_alignment (Pango.Alignment.CENTER);
+                    n_cached_layouts = 0;
+                }
+
+                cached.layout = create_layout (text, layout_width);
+                n_cached_layouts++;
+
+                /* calculate the real text dimension */
+                cached.layout.get_pixel_size (out cached.width, out cached.height);
+                cached.measured = true;
             }
 
-            layout.set_text (text, -1);
+            render_layout = cached.layout;
+            text_width = cached.width;
+            text_height = cached.height;
+        }
+
+        private Pango.Layout create_layout (string text, int layout_width) {
+            var new_layout = layout.copy ();
+            new_layout.set_width (layout_width * Pango.SCALE);
+            if (is_list_view) {
+                new_layout.set_height (- 1);
+            } else {
+                new_layout.set_wrap (this.wrap_mode);
+                new_layout.set_height (- MAX_LINES);
+                new_layout.set_alignment (Pango.Alignment.CENTER);
+            }
+
+            new_layout.set_ellipsize (Pango.EllipsizeMode.END);
+            new_layout.set_text (text, -1);
+            return new_layout;
+        }
 
-            /* calculate the real text dimension */
-            int width, height;
-            layout.get_pixel_size (out width, out height);
-            text_width = width;
-            text_height = height;
+        private void clear_layout_cache () {
+            render_layout = null;
+            layout_cache.remove_all ();
+            n_cached_layouts = 0;
         }
 
         public override unowned Gtk.CellEditable? start_editing (Gdk.Event? event,
@@ -249,6 +301,7 @@ namespace Files {
             }
 
             widget = _widget;
+            clear_layout_cache ();
 
             if (widget != null) {
                 connect_widget_signals ();
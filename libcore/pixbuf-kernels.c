@@ -0,0 +1,447 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "pixbuf-kernels.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PF_PIXBUF_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+typedef void (*LightenFunc) (const guint8 *src, gint src_stride, guint8 *dest, gint dest_stride,
+                             gint width, gint height, gint n_channels);
+typedef void (*DarkenFunc) (const guint8 *src, gint src_stride, guint8 *dest, gint dest_stride,
+                            gint width, gint height, gint n_channels, guint8 saturation, guint8 darken);
+typedef void (*LucentFunc) (const guint8 *src, gint src_stride, guint8 *dest, gint dest_stride,
+                            gint width, gint height, gint n_channels, guint percent);
+
+typedef struct {
+    const gchar *name;
+    LightenFunc lighten;
+    DarkenFunc darken;
+    LucentFunc lucent;
+} PixbufKernels;
+
+/* Scalar implementations.  These also process the tails of rows that are too short for the vector code. */
+
+static inline guint8
+lighten_component (guint8 value)
+{
+    guint new_value = value + 24 + (value >> 3);
+    return new_value > G_MAXUINT8 ? G_MAXUINT8 : (guint8) new_value;
+}
+
+static inline void
+lighten_span (const guint8 *src, guint8 *dest, gint n_pixels, gint n_channels)
+{
+    for (gint j = 0; j < n_pixels; j++, src += n_channels, dest += n_channels) {
+        dest[0] = lighten_component (src[0]);
+        dest[1] = lighten_component (src[1]);
+        dest[2] = lighten_component (src[2]);
+        if (n_channels == 4) {
+            dest[3] = src[3];
+        }
+    }
+}
+
+static inline void
+darken_span (const guint8 *src, guint8 *dest, gint n_pixels, gint n_channels, guint negalpha, guint alpha)
+{
+    for (gint j = 0; j < n_pixels; j++, src += n_channels, dest += n_channels) {
+        guint intensity = (src[0] * 77 + src[1] * 150 + src[2] * 28) >> 8;
+        dest[0] = (guint8) ((negalpha * intensity + alpha * src[0]) >> 8);
+        dest[1] = (guint8) ((negalpha * intensity + alpha * src[1]) >> 8);
+        dest[2] = (guint8) ((negalpha * intensity + alpha * src[2]) >> 8);
+        if (n_channels == 4) {
+            dest[3] = src[3];
+        }
+    }
+}
+
+static inline void
+lucent_span (const guint8 *src, guint8 *dest, gint n_pixels, gint n_channels, guint percent)
+{
+    if (n_channels == 4) {
+        for (gint j = 0; j < n_pixels; j++, src += 4, dest += 4) {
+            dest[0] = src[0];
+            dest[1] = src[1];
+            dest[2] = src[2];
+            dest[3] = (guint8) ((src[3] * percent) / 100);
+        }
+    } else {
+        guint8 alpha = (guint8) ((G_MAXUINT8 * percent) / 100);
+        for (gint j = 0; j < n_pixels; j++, src += 3, dest += 4) {
+            dest[0] = src[0];
+            dest[1] = src[1];
+            dest[2] = src[2];
+            dest[3] = alpha;
+        }
+    }
+}
+
+static void
+lighten_scalar (const guint8 *src, gint src_stride, guint8 *dest, gint dest_stride,
+                gint width, gint height, gint n_channels)
+{
+    for (gint i = 0; i < height; i++) {
+        lighten_span (src + i * src_stride, dest + i * dest_stride, width, n_channels);
+    }
+}
+
+static void
+darken_scalar (const guint8 *src, gint src_stride, guint8 *dest, gint dest_stride,
+               gint width, gint height, gint n_channels, guint8 saturation, guint8 darken)
+{
+    guint negalpha = ((G_MAXUINT8 - saturation) * darken) >> 8;
+    guint alpha = (saturation * darken) >> 8;
+
+    for (gint i = 0; i < height; i++) {
+        darken_span (src + i * src_stride, dest + i * dest_stride, width, n_channels, negalpha, alpha);
+    }
+}
+
+static void
+lucent_scalar (const guint8 *src, gint src_stride, guint8 *dest, gint dest_stride,
+               gint width, gint height, gint n_channels, guint percent)
+{
+    for (gint i = 0; i < height; i++) {
+        lucent_span (src + i * src_stride, dest + i * dest_stride, width, n_channels, percent);
+    }
+}
+
+static const PixbufKernels scalar_kernels = {
+    "scalar", lighten_scalar, darken_scalar, lucent_scalar
+};
+
+#ifdef PF_PIXBUF_KERNELS_X86
+
+/* For x <= 25500, x / 100 == ((x * 41944) >> 16) >> 6 */
+#define DIV100_MAGIC 41944
+#define DIV100_SHIFT 6
+
+/* SSE2: 16 bytes per step */
+
+__attribute__ ((target ("sse2"))) static inline __m128i
+lighten_sse2 (__m128i px)
+{
+    /* Saturating at each step gives the same result as saturating the final sum */
+    __m128i eighth = _mm_and_si128 (_mm_srli_epi16 (px, 3), _mm_set1_epi8 (0x1f));
+    return _mm_adds_epu8 (_mm_adds_epu8 (px, eighth), _mm_set1_epi8 (24));
+}
+
+__attribute__ ((target ("sse2"))) static void
+lighten_rows_sse2 (const guint8 *src, gint src_stride, guint8 *dest, gint dest_stride,
+                   gint width, gint height, gint n_channels)
+{
+    /* RGB rows have no alpha so every byte is lightened */
+    const __m128i alpha_mask = n_channels == 4 ? _mm_set1_epi32 ((gint) 0xff000000) : _mm_setzero_si128 ();
+    const gint step = n_channels == 4 ? 4 : 16;
+
+    for (gint i = 0; i < height; i++) {
+        const guint8 *s = src + i * src_stride;
+        guint8 *d = dest + i * dest_stride;
+        gint j = 0;
+
+        /* For RGB only whole runs of 16 pixels keep the vectors aligned to pixel boundaries */
+        for (; j + step <= width; j += step) {
+            gint offset = j * n_channels;
+            for (gint k = 0; k < (n_channels == 4 ? 1 : 3); k++, offset += 16) {
+                __m128i px = _mm_loadu_si128 ((const __m128i *) (s + offset));
+                __m128i res = _mm_or_si128 (_mm_andnot_si128 (alpha_mask, lighten_sse2 (px)),
+                                            _mm_and_si128 (alpha_mask, px));
+                _mm_storeu_si128 ((__m128i *) (d + offset), res);
+            }
+        }
+
+        lighten_span (s + j * n_channels, d + j * n_channels, width - j, n_channels);
+    }
+}
+
+/* Darkens four RGBA pixels */
+__attribute__ ((target ("sse2"))) static inline __m128i
+darken_sse2 (__m128i px, __m128i negalpha, __m128i alpha)
+{
+    const __m128i zero = _mm_setzero_si128 ();
+    const __m128i weights = _mm_setr_epi16 (77, 150, 28, 0, 77, 150, 28, 0);
+    const __m128i alpha_mask = _mm_set1_epi32 ((gint) 0xff000000);
+    __m128i halves[2] = { _mm_unpacklo_epi8 (px, zero), _mm_unpackhi_epi8 (px, zero) };
+
+    for (gint h = 0; h < 2; h++) {
+        /* r * 77 + g * 150 and b * 28 per pixel, then summed into both 32 bit lanes of the pixel */
+        __m128i sums = _mm_madd_epi16 (halves[h], weights);
+        sums = _mm_add_epi32 (sums, _mm_shuffle_epi32 (sums, _MM_SHUFFLE (2, 3, 0, 1)));
+        __m128i intensity = _mm_srli_epi32 (sums, 8);
+        /* Broadcast each pixel's intensity to its four 16 bit channel lanes */
+        intensity = _mm_shufflelo_epi16 (intensity, _MM_SHUFFLE (0, 0, 0, 0));
+        intensity = _mm_shufflehi_epi16 (intensity, _MM_SHUFFLE (0, 0, 0, 0));
+        /* negalpha + alpha < 256 so the sum cannot overflow 16 bits */
+        halves[h] = _mm_srli_epi16 (_mm_add_epi16 (_mm_mullo_epi16 (negalpha, intensity),
+                                                   _mm_mullo_epi16 (alpha, halves[h])), 8);
+    }
+
+    return _mm_or_si128 (_mm_andnot_si128 (alpha_mask, _mm_packus_epi16 (halves[0], halves[1])),
+                         _mm_and_si128 (alpha_mask, px));
+}
+
+__attribute__ ((target ("sse2"))) static void
+darken_rows_sse2 (const guint8 *src, gint src_stride, guint8 *dest, gint dest_stride,
+                  gint width, gint height, gint n_channels, guint8 saturation, guint8 darken)
+{
+    guint negalpha = ((G_MAXUINT8 - saturation) * darken) >> 8;
+    guint alpha = (saturation * darken) >> 8;
+
+    if (n_channels != 4) {
+        darken_scalar (src, src_stride, dest, dest_stride, width, height, n_channels, saturation, darken);
+        return;
+    }
+
+    const __m128i v_negalpha = _mm_set1_epi16 ((gshort) negalpha);
+    const __m128i v_alpha = _mm_set1_epi16 ((gshort) alpha);
+
+    for (gint i = 0; i < height; i++) {
+        const guint8 *s = src + i * src_stride;
+        guint8 *d = dest + i * dest_stride;
+        gint j = 0;
+
+        for (; j + 4 <= width; j += 4) {
+            __m128i px = _mm_loadu_si128 ((const __m128i *) (s + j * 4));
+            _mm_storeu_si128 ((__m128i *) (d + j * 4), darken_sse2 (px, v_negalpha, v_alpha));
+        }
+
+        darken_span (s + j * 4, d + j * 4, width - j, 4, negalpha, alpha);
+    }
+}
+
+/* Scales the alpha of four RGBA pixels by percent */
+__attribute__ ((target ("sse2"))) static inline __m128i
+lucent_sse2 (__m128i px, __m128i percent)
+{
+    const __m128i rgb_mask = _mm_set1_epi32 (0x00ffffff);
+    __m128i a = _mm_mullo_epi16 (_mm_srli_epi32 (px, 24), percent);
+    a = _mm_srli_epi32 (_mm_mulhi_epu16 (a, _mm_set1_epi32 (DIV100_MAGIC)), DIV100_SHIFT);
+    return _mm_or_si128 (_mm_and_si128 (px, rgb_mask), _mm_slli_epi32 (a, 24));
+}
+
+__attribute__ ((target ("sse2"))) static void
+lucent_rows_sse2 (const guint8 *src, gint src_stride, guint8 *dest, gint dest_stride,
+                  gint width, gint height, gint n_channels, guint percent)
+{
+    if (n_channels != 4) {
+        lucent_scalar (src, src_stride, dest, dest_stride, width, height, n_channels, percent);
+        return;
+    }
+
+    const __m128i v_percent = _mm_set1_epi32 ((gint) percent);
+
+    for (gint i = 0; i < height; i++) {
+        const guint8 *s = src + i * src_stride;
+        guint8 *d = dest + i * dest_stride;
+        gint j = 0;
+
+        for (; j + 4 <= width; j += 4) {
+            __m128i px = _mm_loadu_si128 ((const __m128i *) (s + j * 4));
+            _mm_storeu_si128 ((__m128i *) (d + j * 4), lucent_sse2 (px, v_percent));
+        }
+
+        lucent_span (s + j * 4, d + j * 4, width - j, 4, percent);
+    }
+}
+
+static const PixbufKernels sse2_kernels = {
+    "sse2", lighten_rows_sse2, darken_rows_sse2, lucent_rows_sse2
+};
+
+/* AVX2: 32 bytes per step.  All shuffles used are lane local so the SSE2 arithmetic carries over directly */
+
+__attribute__ ((target ("avx2"))) static void
+lighten_rows_avx2 (const guint8 *src, gint src_stride, guint8 *dest, gint dest_stride,
+                   gint width, gint height, gint n_channels)
+{
+    const __m256i alpha_mask = n_channels == 4 ? _mm256_set1_epi32 ((gint) 0xff000000) : _mm256_setzero_si256 ();
+    const __m256i mask_1f = _mm256_set1_epi8 (0x1f);
+    const __m256i add_24 = _mm256_set1_epi8 (24);
+    const gint step = n_channels == 4 ? 8 : 32;
+
+    for (gint i = 0; i < height; i++) {
+        const guint8 *s = src + i * src_stride;
+        guint8 *d = dest + i * dest_stride;
+        gint j = 0;
+
+        for (; j + step <= width; j += step) {
+            gint offset = j * n_channels;
+            for (gint k = 0; k < (n_channels == 4 ? 1 : 3); k++, offset += 32) {
+                __m256i px = _mm256_loadu_si256 ((const __m256i *) (s + offset));
+                __m256i eighth = _mm256_and_si256 (_mm256_srli_epi16 (px, 3), mask_1f);
+                __m256i lit = _mm256_adds_epu8 (_mm256_adds_epu8 (px, eighth), add_24);
+                __m256i res = _mm256_or_si256 (_mm256_andnot_si256 (alpha_mask, lit),
+                                               _mm256_and_si256 (alpha_mask, px));
+                _mm256_storeu_si256 ((__m256i *) (d + offset), res);
+            }
+        }
+
+        lighten_span (s + j * n_channels, d + j * n_channels, width - j, n_channels);
+    }
+}
+
+__attribute__ ((target ("avx2"))) static void
+darken_rows_avx2 (const guint8 *src, gint src_stride, guint8 *dest, gint dest_stride,
+                  gint width, gint height, gint n_channels, guint8 saturation, guint8 darken)
+{
+    guint negalpha = ((G_MAXUINT8 - saturation) * darken) >> 8;
+    guint alpha = (saturation * darken) >> 8;
+
+    if (n_channels != 4) {
+        darken_scalar (src, src_stride, dest, dest_stride, width, height, n_channels, saturation, darken);
+        return;
+    }
+
+    const __m256i zero = _mm256_setzero_si256 ();
+    const __m256i weights = _mm256_setr_epi16 (77, 150, 28, 0, 77, 150, 28, 0,
+                                               77, 150, 28, 0, 77, 150, 28, 0);
+    const __m256i alpha_mask = _mm256_set1_epi32 ((gint) 0xff000000);
+    const __m256i v_negalpha = _mm256_set1_epi16 ((gshort) negalpha);
+    const __m256i v_alpha = _mm256_set1_epi16 ((gshort) alpha);
+
+    for (gint i = 0; i < height; i++) {
+        const guint8 *s = src + i * src_stride;
+        guint8 *d = dest + i * dest_stride;
+        gint j = 0;
+
+        for (; j + 8 <= width; j += 8) {
+            __m256i px = _mm256_loadu_si256 ((const __m256i *) (s + j * 4));
+            __m256i halves[2] = { _mm256_unpacklo_epi8 (px, zero), _mm256_unpackhi_epi8 (px, zero) };
+
+            for (gint h = 0; h < 2; h++) {
+                __m256i sums = _mm256_madd_epi16 (halves[h], weights);
+                sums = _mm256_add_epi32 (sums, _mm256_shuffle_epi32 (sums, _MM_SHUFFLE (2, 3, 0, 1)));
+                __m256i intensity = _mm256_srli_epi32 (sums, 8);
+                intensity = _mm256_shufflelo_epi16 (intensity, _MM_SHUFFLE (0, 0, 0, 0));
+                intensity = _mm256_shufflehi_epi16 (intensity, _MM_SHUFFLE (0, 0, 0, 0));
+                halves[h] = _mm256_srli_epi16 (_mm256_add_epi16 (_mm256_mullo_epi16 (v_negalpha, intensity),
+                                                                 _mm256_mullo_epi16 (v_alpha, halves[h])), 8);
+            }
+
+            __m256i res = _mm256_or_si256 (_mm256_andnot_si256 (alpha_mask, _mm256_packus_epi16 (halves[0], halves[1])),
+                                           _mm256_and_si256 (alpha_mask, px));
+            _mm256_storeu_si256 ((__m256i *) (d + j * 4), res);
+        }
+
+        darken_span (s + j * 4, d + j * 4, width - j, 4, negalpha, alpha);
+    }
+}
+
+__attribute__ ((target ("avx2"))) static void
+lucent_rows_avx2 (const guint8 *src, gint src_stride, guint8 *dest, gint dest_stride,
+                  gint width, gint height, gint n_channels, guint percent)
+{
+    if (n_channels == 4) {
+        const __m256i rgb_mask = _mm256_set1_epi32 (0x00ffffff);
+        const __m256i v_percent = _mm256_set1_epi32 ((gint) percent);
+        const __m256i magic = _mm256_set1_epi32 (DIV100_MAGIC);
+
+        for (gint i = 0; i < height; i++) {
+            const guint8 *s = src + i * src_stride;
+            guint8 *d = dest + i * dest_stride;
+            gint j = 0;
+
+            for (; j + 8 <= width; j += 8) {
+                __m256i px = _mm256_loadu_si256 ((const __m256i *) (s + j * 4));
+                __m256i a = _mm256_mullo_epi16 (_mm256_srli_epi32 (px, 24), v_percent);
+                a = _mm256_srli_epi32 (_mm256_mulhi_epu16 (a, magic), DIV100_SHIFT);
+                _mm256_storeu_si256 ((__m256i *) (d + j * 4),
+                                     _mm256_or_si256 (_mm256_and_si256 (px, rgb_mask), _mm256_slli_epi32 (a, 24)));
+            }
+
+            lucent_span (s + j * 4, d + j * 4, width - j, 4, percent);
+        }
+    } else {
+        /* Expand RGB to RGBA four pixels at a time; a 16 byte load covers 12 bytes of pixels */
+        const __m128i expand = _mm_setr_epi8 (0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i v_alpha = _mm_set1_epi32 ((gint) (((G_MAXUINT8 * percent) / 100) << 24));
+
+        for (gint i = 0; i < height; i++) {
+            const guint8 *s = src + i * src_stride;
+            guint8 *d = dest + i * dest_stride;
+            gint j = 0;
+
+            for (; (width - j) * 3 >= 16; j += 4) {
+                __m128i px = _mm_loadu_si128 ((const __m128i *) (s + j * 3));
+                _mm_storeu_si128 ((__m128i *) (d + j * 4), _mm_or_si128 (_mm_shuffle_epi8 (px, expand), v_alpha));
+            }
+
+            lucent_span (s + j * 3, d + j * 4, width - j, 3, percent);
+        }
+    }
+}
+
+static const PixbufKernels avx2_kernels = {
+    "avx2", lighten_rows_avx2, darken_rows_avx2, lucent_rows_avx2
+};
+
+#endif /* PF_PIXBUF_KERNELS_X86 */
+
+static const PixbufKernels *
+get_kernels (void)
+{
+    static gsize kernels = 0;
+
+    if (g_once_init_enter (&kernels)) {
+        const PixbufKernels *selected = &scalar_kernels;
+        /* Allows comparing implementations, e.g. when benchmarking */
+        const gchar *limit = g_getenv ("PF_PIXBUF_KERNELS");
+
+#ifdef PF_PIXBUF_KERNELS_X86
+        __builtin_cpu_init ();
+        if (g_strcmp0 (limit, "scalar") != 0) {
+            if (__builtin_cpu_supports ("avx2") && g_strcmp0 (limit, "sse2") != 0) {
+                selected = &avx2_kernels;
+            } else if (__builtin_cpu_supports ("sse2")) {
+                selected = &sse2_kernels;
+            }
+        }
+#endif
+
+        g_debug ("Using %s pixbuf kernels", selected->name);
+        g_once_init_leave (&kernels, (gsize) selected);
+    }
+
+    return (const PixbufKernels *) kernels;
+}
+
+void
+pf_pixbuf_kernels_lighten (const guint8 *src, gint src_stride, guint8 *dest, gint dest_stride,
+                           gint width, gint height, gint n_channels)
+{
+    g_return_if_fail (n_channels == 3 || n_channels == 4);
+
+    get_kernels ()->lighten (src, src_stride, dest, dest_stride, width, height, n_channels);
+}
+
+void
+pf_pixbuf_kernels_darken (const guint8 *src, gint src_stride, guint8 *dest, gint dest_stride,
+                          gint width, gint height, gint n_channels, guint8 saturation, guint8 darken)
+{
+    g_return_if_fail (n_channels == 3 || n_channels == 4);
+
+    get_kernels ()->darken (src, src_stride, dest, dest_stride, width, height, n_channels, saturation, darken);
+}
+
+void
+pf_pixbuf_kernels_lucent (const guint8 *src, gint src_stride, guint8 *dest, gint dest_stride,
+                          gint width, gint height, gint n_channels, guint percent)
+{
+    g_return_if_fail (n_channels == 3 || n_channels == 4);
+    g_return_if_fail (percent <= 100);
+
+    get_kernels ()->lucent (src, src_stride, dest, dest_stride, width, height, n_channels, percent);
+}
+
+const gchar *
+pf_pixbuf_kernels_get_implementation (void)
+{
+    return get_kernels ()->name;
+}
@@ -0,0 +1,49 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Pixel kernels used by PF.PixbufUtils.  All kernels operate on 8 bit per sample
+ * RGB or RGBA rows; the widest implementation supported by the running CPU is
+ * selected the first time any kernel is called.
+ */
+
+#ifndef PF_PIXBUF_KERNELS_H
+#define PF_PIXBUF_KERNELS_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+void pf_pixbuf_kernels_lighten (const guint8 *src,
+                                gint          src_stride,
+                                guint8       *dest,
+                                gint          dest_stride,
+                                gint          width,
+                                gint          height,
+                                gint          n_channels);
+
+void pf_pixbuf_kernels_darken (const guint8 *src,
+                               gint          src_stride,
+                               guint8       *dest,
+                               gint          dest_stride,
+                               gint          width,
+                               gint          height,
+                               gint          n_channels,
+                               guint8        saturation,
+                               guint8        darken);
+
+/* The destination always has four channels */
+void pf_pixbuf_kernels_lucent (const guint8 *src,
+                               gint          src_stride,
+                               guint8       *dest,
+                               gint          dest_stride,
+                               gint          width,
+                               gint          height,
+                               gint          n_channels,
+                               guint         percent);
+
+const gchar *pf_pixbuf_kernels_get_implementation (void);
+
+G_END_DECLS
+
+#endif /* PF_PIXBUF_KERNELS_H */
@@ -0,0 +1,518 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define _GNU_SOURCE
+
+#include "recursive-watch.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/fanotify.h>
+#endif
+
+/* Filesystem marks reporting the parent folder and name need Linux 5.9 */
+#if defined (FAN_REPORT_DFID_NAME) && defined (FAN_MARK_FILESYSTEM)
+#define HAVE_FANOTIFY_FID 1
+#endif
+
+#define INOTIFY_MASK (IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | \
+                      IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_ONLYDIR | IN_DONT_FOLLOW)
+
+#define READ_BUFFER_SIZE 16384
+
+struct _PfRecursiveWatch {
+    gchar *root;
+    gint fd;
+    gboolean fanotify;
+    gint root_fd;            /* fanotify: resolves folder handles and detects deletion of the root */
+    GHashTable *wd_to_path;  /* inotify: watch descriptor to path, owns the paths */
+    GHashTable *path_to_wd;
+    GQueue pending_dirs;     /* inotify: folders still to be watched, breadth first */
+    guint max_watches;
+    gboolean complete;
+};
+
+static gboolean
+is_below_root (PfRecursiveWatch *watch, const gchar *path)
+{
+    gsize root_len = strlen (watch->root);
+
+    if (root_len == 1 && watch->root[0] == '/') {
+        return TRUE;
+    }
+
+    return strncmp (path, watch->root, root_len) == 0 &&
+           (path[root_len] == '\0' || path[root_len] == '/');
+}
+
+/* inotify backend */
+
+static void
+forget_watch (PfRecursiveWatch *watch, gint wd)
+{
+    const gchar *path = g_hash_table_lookup (watch->wd_to_path, GINT_TO_POINTER (wd));
+
+    if (path != NULL) {
+        g_hash_table_remove (watch->path_to_wd, path);
+        g_hash_table_remove (watch->wd_to_path, GINT_TO_POINTER (wd));
+    }
+}
+
+static gboolean
+add_watch (PfRecursiveWatch *watch, const gchar *path)
+{
+    gint wd;
+    gchar *owned_path;
+
+    if (g_hash_table_size (watch->wd_to_path) >= watch->max_watches) {
+        watch->complete = FALSE;
+        return FALSE;
+    }
+
+    wd = inotify_add_watch (watch->fd, path, INOTIFY_MASK);
+    if (wd < 0) {
+        if (errno == ENOSPC) {
+            /* The user limit on watches has been reached */
+            watch->complete = FALSE;
+            return FALSE;
+        }
+
+        /* Unreadable or already gone, carry on with the other folders */
+        return TRUE;
+    }
+
+    /* The same folder may be added again after being moved within the tree */
+    forget_watch (watch, wd);
+    owned_path = g_strdup (path);
+    g_hash_table_insert (watch->wd_to_path, GINT_TO_POINTER (wd), owned_path);
+    g_hash_table_insert (watch->path_to_wd, owned_path, GINT_TO_POINTER (wd));
+    return TRUE;
+}
+
+static gboolean
+is_directory (const gchar *parent, const struct dirent *entry)
+{
+    struct stat st;
+    gchar *path;
+    gboolean result;
+
+    if (entry->d_type != DT_UNKNOWN) {
+        return entry->d_type == DT_DIR;
+    }
+
+    path = g_build_filename (parent, entry->d_name, NULL);
+    result = lstat (path, &st) == 0 && S_ISDIR (st.st_mode);
+    g_free (path);
+    return result;
+}
+
+/* Watches the next pending folder and queues the folders in it. Folders are watched breadth first so that the
+ * budget is spent on the shallowest folders, and once it is spent the remaining folders are dropped. */
+static void
+add_next_pending (PfRecursiveWatch *watch)
+{
+    gchar *dir_path = g_queue_pop_head (&watch->pending_dirs);
+    DIR *dir;
+    struct dirent *entry;
+
+    if (!add_watch (watch, dir_path)) {
+        g_free (dir_path);
+        g_queue_clear_full (&watch->pending_dirs, g_free);
+        return;
+    }
+
+    dir = opendir (dir_path);
+    if (dir != NULL) {
+        while ((entry = readdir (dir)) != NULL) {
+            if (strcmp (entry->d_name, ".") == 0 || strcmp (entry->d_name, "..") == 0) {
+                continue;
+            }
+
+            if (is_directory (dir_path, entry)) {
+                g_queue_push_tail (&watch->pending_dirs, g_build_filename (dir_path, entry->d_name, NULL));
+            }
+        }
+
+        closedir (dir);
+    }
+
+    g_free (dir_path);
+}
+
+/* Watches @path and the folders below it */
+static void
+add_tree (PfRecursiveWatch *watch, const gchar *path)
+{
+    g_queue_push_tail (&watch->pending_dirs, g_strdup (path));
+    while (!g_queue_is_empty (&watch->pending_dirs)) {
+        add_next_pending (watch);
+    }
+}
+
+/* Stops watching @path and the folders below it, e.g. when moved out of the tree */
+static void
+remove_tree (PfRecursiveWatch *watch, const gchar *path)
+{
+    GHashTableIter iter;
+    gpointer key, value;
+    GArray *wds = g_array_new (FALSE, FALSE, sizeof (gint));
+    gsize path_len = strlen (path);
+
+    g_hash_table_iter_init (&iter, watch->path_to_wd);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+        const gchar *watched = key;
+
+        if (strncmp (watched, path, path_len) == 0 && (watched[path_len] == '\0' || watched[path_len] == '/')) {
+            gint wd = GPOINTER_TO_INT (value);
+            g_array_append_val (wds, wd);
+        }
+    }
+
+    for (guint i = 0; i < wds->len; i++) {
+        gint wd = g_array_index (wds, gint, i);
+        inotify_rm_watch (watch->fd, wd);
+        forget_watch (watch, wd);
+    }
+
+    g_array_unref (wds);
+}
+
+static gboolean
+init_inotify (PfRecursiveWatch *watch)
+{
+    watch->fd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->fd < 0) {
+        return FALSE;
+    }
+
+    watch->wd_to_path = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+    watch->path_to_wd = g_hash_table_new (g_str_hash, g_str_equal);
+    add_tree (watch, watch->root);
+    return g_hash_table_size (watch->wd_to_path) > 0;
+}
+
+static gboolean
+dispatch_inotify (PfRecursiveWatch *watch, PfRecursiveWatchFunc func, gpointer user_data)
+{
+    gchar buf[READ_BUFFER_SIZE] __attribute__ ((aligned (__alignof__ (struct inotify_event))));
+
+    for (;;) {
+        gssize len = read (watch->fd, buf, sizeof (buf));
+        const gchar *ptr;
+
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return errno == EAGAIN;
+        }
+
+        for (ptr = buf; ptr < buf + len; ptr += sizeof (struct inotify_event) + ((const struct inotify_event *) ptr)->len) {
+            const struct inotify_event *event = (const struct inotify_event *) ptr;
+            const gchar *dir_path;
+            gchar *path;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                func (watch->root, PF_RECURSIVE_WATCH_EVENT_OVERFLOW, user_data);
+                continue;
+            }
+
+            dir_path = g_hash_table_lookup (watch->wd_to_path, GINT_TO_POINTER (event->wd));
+            if (dir_path == NULL) {
+                continue;
+            }
+
+            if (event->mask & IN_IGNORED) {
+                forget_watch (watch, event->wd);
+                continue;
+            }
+
+            if (event->mask & IN_DELETE_SELF) {
+                if (strcmp (dir_path, watch->root) == 0) {
+                    func (watch->root, PF_RECURSIVE_WATCH_EVENT_DELETED, user_data);
+                    return FALSE;
+                }
+
+                continue; /* Reported by the parent folder */
+            }
+
+            path = event->len > 0 ? g_build_filename (dir_path, event->name, NULL) : g_strdup (dir_path);
+            if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                if (event->mask & IN_ISDIR) {
+                    /* A large tree moved in is watched in steps by pf_recursive_watch_add_pending () */
+                    g_queue_push_tail (&watch->pending_dirs, g_strdup (path));
+                }
+
+                func (path, PF_RECURSIVE_WATCH_EVENT_CREATED, user_data);
+            } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                if ((event->mask & IN_ISDIR) && (event->mask & IN_MOVED_FROM)) {
+                    remove_tree (watch, path);
+                }
+
+                func (path, PF_RECURSIVE_WATCH_EVENT_DELETED, user_data);
+            } else {
+                func (path, PF_RECURSIVE_WATCH_EVENT_CHANGED, user_data);
+            }
+
+            g_free (path);
+        }
+    }
+}
+
+/* fanotify backend */
+
+#ifdef HAVE_FANOTIFY_FID
+#define FANOTIFY_MASK (FAN_CREATE | FAN_DELETE | FAN_MODIFY | FAN_ATTRIB | FAN_MOVED_FROM | FAN_MOVED_TO | FAN_ONDIR)
+
+static gboolean
+can_resolve_handles (PfRecursiveWatch *watch)
+{
+    struct {
+        struct file_handle handle;
+        guchar data[MAX_HANDLE_SZ];
+    } root_handle;
+    gint mount_id;
+    gint fd;
+
+    root_handle.handle.handle_bytes = MAX_HANDLE_SZ;
+    if (name_to_handle_at (watch->root_fd, "", &root_handle.handle, &mount_id, AT_EMPTY_PATH) < 0) {
+        return FALSE;
+    }
+
+    /* Needs CAP_DAC_READ_SEARCH, which is not implied by being allowed to mark the filesystem */
+    fd = open_by_handle_at (watch->root_fd, &root_handle.handle, O_PATH | O_CLOEXEC);
+    if (fd < 0) {
+        return FALSE;
+    }
+
+    close (fd);
+    return TRUE;
+}
+
+static gboolean
+init_fanotify (PfRecursiveWatch *watch)
+{
+    /* Filesystem marks need CAP_SYS_ADMIN so this usually fails with EPERM */
+    gint fd = fanotify_init (FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK | FAN_REPORT_DFID_NAME,
+                             O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return FALSE;
+    }
+
+    if (fanotify_mark (fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, FANOTIFY_MASK, AT_FDCWD, watch->root) < 0) {
+        close (fd);
+        return FALSE;
+    }
+
+    watch->root_fd = open (watch->root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (watch->root_fd < 0 || !can_resolve_handles (watch)) {
+        close (fd);
+        return FALSE;
+    }
+
+    watch->fd = fd;
+    watch->fanotify = TRUE;
+    return TRUE;
+}
+
+static gchar *
+resolve_event_path (PfRecursiveWatch *watch, const struct fanotify_event_info_fid *fid)
+{
+    struct file_handle *handle = (struct file_handle *) fid->handle;
+    const gchar *name = (const gchar *) handle->f_handle + handle->handle_bytes;
+    gchar proc_path[64];
+    gchar *dir_path;
+    gchar *path;
+    gint dir_fd;
+
+    dir_fd = open_by_handle_at (watch->root_fd, handle, O_PATH | O_CLOEXEC);
+    if (dir_fd < 0) {
+        return NULL; /* The folder has gone since, its deletion is reported separately */
+    }
+
+    g_snprintf (proc_path, sizeof (proc_path), "/proc/self/fd/%d", dir_fd);
+    dir_path = g_file_read_link (proc_path, NULL);
+    close (dir_fd);
+    if (dir_path == NULL) {
+        return NULL;
+    }
+
+    path = strcmp (name, ".") == 0 ? g_strdup (dir_path) : g_build_filename (dir_path, name, NULL);
+    g_free (dir_path);
+    return path;
+}
+
+static gboolean
+dispatch_fanotify (PfRecursiveWatch *watch, PfRecursiveWatchFunc func, gpointer user_data)
+{
+    gchar buf[READ_BUFFER_SIZE] __attribute__ ((aligned (__alignof__ (struct fanotify_event_metadata))));
+    struct stat st;
+
+    for (;;) {
+        gssize len = read (watch->fd, buf, sizeof (buf));
+        struct fanotify_event_metadata *meta;
+
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (errno != EAGAIN) {
+                return FALSE;
+            }
+
+            break;
+        }
+
+        for (meta = (struct fanotify_event_metadata *) buf; FAN_EVENT_OK (meta, len); meta = FAN_EVENT_NEXT (meta, len)) {
+            const struct fanotify_event_info_fid *fid;
+            PfRecursiveWatchEvent kind;
+            gchar *path;
+
+            if (meta->vers != FANOTIFY_METADATA_VERSION) {
+                return FALSE;
+            }
+
+            if (meta->mask & FAN_Q_OVERFLOW) {
+                func (watch->root, PF_RECURSIVE_WATCH_EVENT_OVERFLOW, user_data);
+                continue;
+            }
+
+            fid = (const struct fanotify_event_info_fid *) ((const gchar *) meta + meta->metadata_len);
+            if (meta->event_len <= meta->metadata_len || fid->hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME) {
+                continue;
+            }
+
+            /* The mark covers the whole filesystem */
+            path = resolve_event_path (watch, fid);
+            if (path == NULL || !is_below_root (watch, path)) {
+                g_free (path);
+                continue;
+            }
+
+            if (meta->mask & (FAN_CREATE | FAN_MOVED_TO)) {
+                kind = PF_RECURSIVE_WATCH_EVENT_CREATED;
+            } else if (meta->mask & (FAN_DELETE | FAN_MOVED_FROM)) {
+                kind = PF_RECURSIVE_WATCH_EVENT_DELETED;
+            } else {
+                kind = PF_RECURSIVE_WATCH_EVENT_CHANGED;
+            }
+
+            func (path, kind, user_data);
+            g_free (path);
+        }
+    }
+
+    /* Deletion of the root itself cannot be resolved to a path once it has gone */
+    if (fstat (watch->root_fd, &st) == 0 && st.st_nlink == 0) {
+        func (watch->root, PF_RECURSIVE_WATCH_EVENT_DELETED, user_data);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+#endif
+
+PfRecursiveWatch *
+pf_recursive_watch_new (const gchar *root, guint max_watches)
+{
+    PfRecursiveWatch *watch = g_new0 (PfRecursiveWatch, 1);
+
+    watch->root = g_strdup (root);
+    watch->fd = -1;
+    watch->root_fd = -1;
+    watch->max_watches = max_watches;
+    watch->complete = TRUE;
+
+#ifdef HAVE_FANOTIFY_FID
+    if (init_fanotify (watch)) {
+        return watch;
+    }
+
+    if (watch->root_fd >= 0) {
+        close (watch->root_fd);
+        watch->root_fd = -1;
+    }
+#endif
+
+    if (!init_inotify (watch)) {
+        pf_recursive_watch_free (watch);
+        return NULL;
+    }
+
+    return watch;
+}
+
+void
+pf_recursive_watch_free (PfRecursiveWatch *watch)
+{
+    if (watch->fd >= 0) {
+        close (watch->fd);
+    }
+
+    if (watch->root_fd >= 0) {
+        close (watch->root_fd);
+    }
+
+    g_queue_clear_full (&watch->pending_dirs, g_free);
+    g_clear_pointer (&watch->path_to_wd, g_hash_table_destroy);
+    g_clear_pointer (&watch->wd_to_path, g_hash_table_destroy);
+    g_free (watch->root);
+    g_free (watch);
+}
+
+gint
+pf_recursive_watch_get_fd (PfRecursiveWatch *watch)
+{
+    return watch->fd;
+}
+
+const gchar *
+pf_recursive_watch_get_backend (PfRecursiveWatch *watch)
+{
+    return watch->fanotify ? "fanotify" : "inotify";
+}
+
+guint
+pf_recursive_watch_get_n_watches (PfRecursiveWatch *watch)
+{
+    return watch->fanotify ? 0 : g_hash_table_size (watch->wd_to_path);
+}
+
+gboolean
+pf_recursive_watch_is_complete (PfRecursiveWatch *watch)
+{
+    return watch->complete;
+}
+
+gboolean
+pf_recursive_watch_add_pending (PfRecursiveWatch *watch, guint max_folders)
+{
+    for (guint i = 0; i < max_folders && !g_queue_is_empty (&watch->pending_dirs); i++) {
+        add_next_pending (watch);
+    }
+
+    return !g_queue_is_empty (&watch->pending_dirs);
+}
+
+gboolean
+pf_recursive_watch_dispatch (PfRecursiveWatch *watch, PfRecursiveWatchFunc func, gpointer user_data)
+{
+#ifdef HAVE_FANOTIFY_FID
+    if (watch->fanotify) {
+        return dispatch_fanotify (watch, func, user_data);
+    }
+#endif
+
+    return dispatch_inotify (watch, func, user_data);
+}
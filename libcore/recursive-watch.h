@@ -0,0 +1,65 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ *
+ * Watches a folder and every folder below it for changes.  A fanotify
+ * filesystem mark is used where the process is permitted to create one,
+ * otherwise one inotify watch is added per folder up to a budget.  Events
+ * are read from a single file descriptor by pf_recursive_watch_dispatch ().
+ */
+
+#ifndef PF_RECURSIVE_WATCH_H
+#define PF_RECURSIVE_WATCH_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef enum {
+    PF_RECURSIVE_WATCH_EVENT_CREATED,
+    PF_RECURSIVE_WATCH_EVENT_DELETED,
+    PF_RECURSIVE_WATCH_EVENT_CHANGED,
+    /* Events have been lost, the path is the root */
+    PF_RECURSIVE_WATCH_EVENT_OVERFLOW
+} PfRecursiveWatchEvent;
+
+typedef void (*PfRecursiveWatchFunc) (const gchar           *path,
+                                      PfRecursiveWatchEvent  event,
+                                      gpointer               user_data);
+
+typedef struct _PfRecursiveWatch PfRecursiveWatch;
+
+/* Returns NULL if @root cannot be watched at all.  At most @max_watches inotify
+ * watches are used; folders beyond the budget are not watched. */
+PfRecursiveWatch *pf_recursive_watch_new (const gchar *root,
+                                          guint        max_watches);
+
+void pf_recursive_watch_free (PfRecursiveWatch *watch);
+
+gint pf_recursive_watch_get_fd (PfRecursiveWatch *watch);
+
+/* "fanotify" or "inotify" */
+const gchar *pf_recursive_watch_get_backend (PfRecursiveWatch *watch);
+
+/* The number of inotify watches in use */
+guint pf_recursive_watch_get_n_watches (PfRecursiveWatch *watch);
+
+/* Whether every folder below the root is watched */
+gboolean pf_recursive_watch_is_complete (PfRecursiveWatch *watch);
+
+/* Reads the pending events without blocking.  Returns FALSE once the root has
+ * been deleted or the watch can no longer be read.  Folders created or moved
+ * below the root are only queued, to be watched by
+ * pf_recursive_watch_add_pending (). */
+gboolean pf_recursive_watch_dispatch (PfRecursiveWatch     *watch,
+                                      PfRecursiveWatchFunc  func,
+                                      gpointer              user_data);
+
+/* Watches up to @max_folders of the queued folders and the folders found in
+ * them.  Returns whether folders remain queued. */
+gboolean pf_recursive_watch_add_pending (PfRecursiveWatch *watch,
+                                         guint             max_folders);
+
+G_END_DECLS
+
+#endif /* PF_RECURSIVE_WATCH_H */
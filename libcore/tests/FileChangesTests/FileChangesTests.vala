@@ -0,0 +1,65 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+Files.FileChanges.Change make_change (Files.FileChanges.Kind kind, GLib.File file, bool internal = true) {
+    return new Files.FileChanges.Change () {
+        kind = kind,
+        from = file,
+        is_internal = internal
+    };
+}
+
+void add_file_changes_tests () {
+    Test.add_func ("/FileChanges/modify_storm_merged", () => {
+        var parent = GLib.File.new_for_path ("/tmp/build");
+        var batch = new Files.FileChanges.Batch (parent);
+        for (int i = 0; i < 100; i++) {
+            var file = parent.get_child ("object%i.o".printf (i % 10));
+            batch.add (make_change (Files.FileChanges.Kind.ADDED, file, false));
+            batch.add (make_change (Files.FileChanges.Kind.CHANGED, file));
+            batch.add (make_change (Files.FileChanges.Kind.CHANGED, file));
+        }
+
+        assert (batch.raw_count == 300);
+        assert (batch.get_delivered_count () == 10);
+        assert (batch.get_kind (parent.get_child ("object3.o")) == Files.FileChanges.Kind.ADDED);
+    });
+
+    Test.add_func ("/FileChanges/create_delete_collapsed", () => {
+        var parent = GLib.File.new_for_path ("/tmp/build");
+        var file = parent.get_child ("temp");
+        var batch = new Files.FileChanges.Batch (parent);
+        batch.add (make_change (Files.FileChanges.Kind.ADDED, file, false));
+        batch.add (make_change (Files.FileChanges.Kind.CHANGED, file));
+        batch.add (make_change (Files.FileChanges.Kind.FILE_REMOVED, file));
+
+        assert (batch.get_delivered_count () == 1);
+        assert (batch.get_kind (file) == Files.FileChanges.Kind.FILE_REMOVED);
+        assert (!batch.is_replaced (file));
+    });
+
+    Test.add_func ("/FileChanges/delete_create_replaced", () => {
+        var parent = GLib.File.new_for_path ("/tmp/docs");
+        var file = parent.get_child ("saved.txt");
+        var other = parent.get_child ("other.txt");
+        var batch = new Files.FileChanges.Batch (parent);
+        batch.add (make_change (Files.FileChanges.Kind.FILE_REMOVED, file));
+        batch.add (make_change (Files.FileChanges.Kind.ADDED, file, false));
+        batch.add (make_change (Files.FileChanges.Kind.CHANGED, other));
+
+        assert (batch.get_kind (file) == Files.FileChanges.Kind.ADDED);
+        assert (batch.is_replaced (file));
+        assert (batch.get_kind (other) == Files.FileChanges.Kind.CHANGED);
+        assert (batch.get_delivered_count () == 3);
+        assert (batch.get_kind (parent.get_child ("missing")) == Files.FileChanges.Kind.INITIAL);
+    });
+}
+
+int main (string[] args) {
+    Test.init (ref args);
+
+    add_file_changes_tests ();
+    return Test.run ();
+}
@@ -0,0 +1,116 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+string test_dir_path;
+
+Files.File make_test_file (string name) {
+    var location = GLib.File.new_for_path (Path.build_filename (test_dir_path, name));
+    try {
+        location.create (GLib.FileCreateFlags.NONE).close ();
+    } catch (Error e) {
+        assert_not_reached ();
+    }
+
+    var file = Files.File.@get (location);
+    file.query_update ();
+    return file;
+}
+
+string get_names (Files.FlatListModel model) {
+    string[] names = {};
+    Gtk.TreeIter iter;
+    if (model.get_iter_first (out iter)) {
+        do {
+            names += model.file_for_iter (iter).basename;
+        } while (model.iter_next (ref iter));
+    }
+
+    return string.joinv (",", names);
+}
+
+void add_flat_list_model_tests () {
+    Test.add_func ("/FlatListModel/sort_insert_remove", () => {
+        var dir = Files.Directory.from_gfile (GLib.File.new_for_path (test_dir_path));
+        var model = new Files.FlatListModel ();
+        var b = make_test_file ("b");
+        var c = make_test_file ("c");
+        var a = make_test_file ("a");
+
+        model.set_sorting_off ();
+        assert (model.add_file (b, dir));
+        assert (model.add_file (c, dir));
+        assert (model.add_file (a, dir));
+        assert (!model.add_file (a, dir));
+        assert (get_names (model) == "b,c,a");
+
+        int reorders = 0;
+        model.rows_reordered.connect (() => { reorders++; });
+        model.set_sorting_on ();
+        assert (reorders == 1);
+        assert (get_names (model) == "a,b,c");
+        assert (model.get_path_for_first_file (c).get_indices ()[0] == 2);
+
+        var ab = make_test_file ("ab");
+        assert (model.insert_sorted (ab, dir));
+        assert (get_names (model) == "a,ab,b,c");
+        assert (model.sort_pending);
+        assert (model.get_path_for_first_file (b).get_indices ()[0] == 2);
+
+        assert (model.remove_file (a, dir));
+        assert (!model.remove_file (a, dir));
+        assert (model.get_path_for_first_file (a) == null);
+        assert (model.file_for_path (new Gtk.TreePath.from_indices (0)) == ab);
+        assert (model.get_path_for_first_file (c).get_indices ()[0] == 2);
+
+        model.set_sort_column_id (Files.ListModel.ColumnID.FILENAME, Gtk.SortType.DESCENDING);
+        assert (get_names (model) == "c,b,ab");
+
+        model.clear ();
+        assert (model.is_empty);
+        assert (model.get_length () == 0);
+    });
+
+    Test.add_func ("/FlatListModel/row_numbers", () => {
+        var dir = Files.Directory.from_gfile (GLib.File.new_for_path (test_dir_path));
+        var model = new Files.FlatListModel ();
+        model.set_sorting_on ();
+        var files = new Files.File[6];
+        for (int i = 0; i < files.length; i++) {
+            files[i] = make_test_file ("row%d".printf (i + 1));
+            assert (model.insert_sorted (files[i], dir));
+        }
+
+        /* Only the rows up to row3 are renumbered, leaving row4 with a stale number below the first dirty row */
+        var row0 = make_test_file ("row0");
+        assert (model.insert_sorted (row0, dir));
+        assert (model.get_path_for_first_file (files[2]).get_indices ()[0] == 3);
+        assert (model.get_path_for_first_file (files[3]).get_indices ()[0] == 4);
+        assert (model.get_path_for_first_file (row0).get_indices ()[0] == 0);
+
+        assert (model.remove_file (files[1], dir));
+        assert (model.get_path_for_first_file (files[5]).get_indices ()[0] == 5);
+        assert (model.get_path_for_first_file (files[0]).get_indices ()[0] == 1);
+        assert (model.get_path_for_first_file (files[2]).get_indices ()[0] == 2);
+        assert (get_names (model) == "row0,row1,row3,row4,row5,row6");
+    });
+
+    Test.add_func ("/FlatListModel/stale_iter", () => {
+        var dir = Files.Directory.from_gfile (GLib.File.new_for_path (test_dir_path));
+        var model = new Files.FlatListModel ();
+        model.add_file (make_test_file ("x"), dir);
+        Gtk.TreeIter iter;
+        assert (model.get_iter_first (out iter));
+        model.add_file (make_test_file ("y"), dir);
+        assert (model.file_for_iter (iter) == null);
+    });
+}
+
+int main (string[] args) {
+    Test.init (ref args);
+
+    test_dir_path = DirUtils.mkdtemp (Path.build_filename (Environment.get_tmp_dir (), "flat-list-model-XXXXXX"));
+    add_flat_list_model_tests ();
+    return Test.run ();
+}
@@ -0,0 +1,153 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* Reference implementations of the effects, one component at a time */
+uint8 reference_lighten_component (uint8 cur_value) {
+    uint new_value = cur_value;
+    new_value += 24 + (new_value >> 3);
+    return (uint8) uint.min (new_value, uint8.MAX);
+}
+
+uint8 reference_effect (string effect, uint8[] src_pix, int offset, int channel) {
+    if (channel == 3) {
+        return effect == "lucent" ? (uint8) ((src_pix[offset + 3] * 50u) / 100u) : src_pix[offset + 3];
+    }
+
+    switch (effect) {
+        case "lighten":
+            return reference_lighten_component (src_pix[offset + channel]);
+        case "darken":
+            uint8 intensity = (src_pix[offset] * 77 + src_pix[offset + 1] * 150 + src_pix[offset + 2] * 28) >> 8;
+            uint8 negalpha = ((uint8.MAX - 150) * 200) >> 8;
+            uint8 alpha = (150 * 200) >> 8;
+            return (negalpha * intensity + alpha * src_pix[offset + channel]) >> 8;
+        default:
+            return src_pix[offset + channel];
+    }
+}
+
+Gdk.Pixbuf make_test_pixbuf (bool has_alpha, int width, int height) {
+    var pixbuf = new Gdk.Pixbuf (Gdk.Colorspace.RGB, has_alpha, 8, width, height);
+    unowned uint8[] pix = (uint8[]) pixbuf.pixels;
+    var rand = new Rand.with_seed (width * height);
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width * pixbuf.n_channels; j++) {
+            pix[i * pixbuf.rowstride + j] = (uint8) rand.int_range (0, 256);
+        }
+    }
+
+    return pixbuf;
+}
+
+void check_effect (string effect, bool has_alpha) {
+    /* Odd widths exercise the scalar tails of the vector kernels */
+    foreach (int width in new int[] {1, 7, 33, 130}) {
+        var src = make_test_pixbuf (has_alpha, width, 5);
+        Gdk.Pixbuf dest;
+        switch (effect) {
+            case "lighten":
+                dest = PF.PixbufUtils.lighten (src);
+                break;
+            case "darken":
+                dest = PF.PixbufUtils.darken (src, 150, 200);
+                break;
+            default:
+                dest = PF.PixbufUtils.lucent (src, 50);
+                break;
+        }
+
+        assert (dest.width == src.width && dest.height == src.height);
+        unowned uint8[] src_pix = (uint8[]) src.pixels;
+        unowned uint8[] dest_pix = (uint8[]) dest.pixels;
+        for (int i = 0; i < src.height; i++) {
+            for (int j = 0; j < width; j++) {
+                int src_offset = i * src.rowstride + j * src.n_channels;
+                int dest_offset = i * dest.rowstride + j * dest.n_channels;
+                for (int c = 0; c < src.n_channels; c++) {
+                    assert (dest_pix[dest_offset + c] == reference_effect (effect, src_pix, src_offset, c));
+                }
+
+                if (effect == "lucent" && !has_alpha) {
+                    assert (dest_pix[dest_offset + 3] == (255u * 50u) / 100u);
+                }
+            }
+        }
+    }
+}
+
+void add_pixbuf_utils_tests () {
+    Test.add_func ("/PixbufUtils/lighten_rgba", () => { check_effect ("lighten", true); });
+    Test.add_func ("/PixbufUtils/lighten_rgb", () => { check_effect ("lighten", false); });
+    Test.add_func ("/PixbufUtils/darken_rgba", () => { check_effect ("darken", true); });
+    Test.add_func ("/PixbufUtils/darken_rgb", () => { check_effect ("darken", false); });
+    Test.add_func ("/PixbufUtils/lucent_rgba", () => { check_effect ("lucent", true); });
+    Test.add_func ("/PixbufUtils/lucent_rgb", () => { check_effect ("lucent", false); });
+
+    Test.add_func ("/PixbufUtils/result_cached", () => {
+        var src = make_test_pixbuf (true, 16, 16);
+        var lit = PF.PixbufUtils.lighten (src);
+        assert (PF.PixbufUtils.lighten (src) == lit);
+        assert (PF.PixbufUtils.lucent (src, 50) != PF.PixbufUtils.lucent (src, 75));
+        assert (PF.PixbufUtils.darken (src, 150, 200) == PF.PixbufUtils.darken (src, 150, 200));
+    });
+
+    /* Run with "-m perf".  Simulates hovering over a grid of 512px thumbnails, some of them hidden or cut,
+     * and reports the cost of the effects in each redrawn frame.  Set PF_PIXBUF_KERNELS=scalar or sse2 to compare
+     * with narrower implementations. */
+    if (Test.perf ()) {
+        Test.add_func ("/PixbufUtils/perf/hover_grid_512", () => {
+            const int GRID_SIZE = 12;
+            const int FRAMES = 60;
+            Gdk.Pixbuf[] grid = {};
+            for (int i = 0; i < GRID_SIZE; i++) {
+                grid += make_test_pixbuf (true, 512, 512);
+            }
+
+            double cold = 0.0;
+            double warm = 0.0;
+            for (int frame = 0; frame < FRAMES; frame++) {
+                /* Fresh copies defeat the result cache, as when thumbnails are reloaded */
+                Gdk.Pixbuf[] fresh = {};
+                foreach (var pixbuf in grid) {
+                    fresh += pixbuf.copy ();
+                }
+
+                Test.timer_start ();
+                draw_frame (fresh, frame);
+                cold += Test.timer_elapsed ();
+
+                Test.timer_start ();
+                draw_frame (fresh, frame);
+                warm += Test.timer_elapsed ();
+            }
+
+            Test.message ("%s kernels", PF.PixbufUtils.Kernels.get_implementation ());
+            Test.minimized_result (cold * 1000 / FRAMES, "uncached frame: %.3f ms", cold * 1000 / FRAMES);
+            Test.minimized_result (warm * 1000 / FRAMES, "cached frame: %.3f ms", warm * 1000 / FRAMES);
+        });
+    }
+}
+
+/* Mirrors the effects IconRenderer applies: one hovered item, and a third of the grid hidden */
+void draw_frame (Gdk.Pixbuf[] grid, int hovered) {
+    for (int i = 0; i < grid.length; i++) {
+        var pb = grid[i];
+        if (i % 3 == 0) {
+            pb = PF.PixbufUtils.lucent (pb, 75);
+            pb = PF.PixbufUtils.darken (pb, 150, 200);
+        }
+
+        if (i == hovered % grid.length) {
+            pb = PF.PixbufUtils.lighten (pb);
+        }
+    }
+}
+
+int main (string[] args) {
+    Test.init (ref args);
+
+    add_pixbuf_utils_tests ();
+    return Test.run ();
+}
@@ -0,0 +1,49 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+void add_plugin_stats_tests () {
+    Test.add_func ("/PluginStats/buckets", () => {
+        assert (Files.PluginStats.get_bucket (0) == 0);
+        assert (Files.PluginStats.get_bucket (99) == 0);
+        assert (Files.PluginStats.get_bucket (100) == 1);
+        assert (Files.PluginStats.get_bucket (50000) == 3);
+        assert (Files.PluginStats.get_bucket (999999) == 4);
+        assert (Files.PluginStats.get_bucket (5000000) == Files.PluginStats.N_BUCKETS - 1);
+    });
+
+    Test.add_func ("/PluginStats/record", () => {
+        var stats = new Files.PluginStats ("test");
+        stats.record ("update_files_info", 50, 10);
+        stats.record ("update_files_info", 20000, 256);
+        stats.record ("context_menu", 2000000);
+
+        assert (stats.get_calls ("update_files_info") == 2);
+        assert (stats.get_calls ("context_menu") == 1);
+        assert (stats.get_calls ("directory_loaded") == 0);
+
+        var histogram = stats.get_histogram ("update_files_info");
+        assert (histogram.length == Files.PluginStats.N_BUCKETS);
+        assert (histogram[0] == 1 && histogram[3] == 1);
+
+        uint64 calls, items;
+        int64 total_usec, max_usec;
+        var hook = stats.to_variant ().lookup_value ("update_files_info", null);
+        assert (hook != null);
+        hook.get ("(ttxx@at)", out calls, out items, out total_usec, out max_usec, null);
+        assert (calls == 2 && items == 266);
+        assert (total_usec == 20050 && max_usec == 20000);
+
+        var report = stats.to_report ();
+        assert (report.split ("\n").length == 3);
+        assert ("context_menu" in report && "update_files_info" in report);
+    });
+}
+
+int main (string[] args) {
+    Test.init (ref args);
+
+    add_plugin_stats_tests ();
+    return Test.run ();
+}
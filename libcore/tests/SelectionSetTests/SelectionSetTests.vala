@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+string test_dir_path;
+
+Files.File make_test_file (string name, int size) {
+    var path = Path.build_filename (test_dir_path, name);
+    try {
+        if (size < 0) {
+            DirUtils.create (path, 0755);
+        } else {
+            GLib.FileUtils.set_contents (path, string.nfill (size, 'x'));
+        }
+    } catch (Error e) {
+        assert_not_reached ();
+    }
+
+    var file = Files.File.@get (GLib.File.new_for_path (path));
+    file.query_update ();
+    return file;
+}
+
+void add_selection_set_tests () {
+    Test.add_func ("/SelectionSet/update", () => {
+        var folder = make_test_file ("folder", -1);
+        var small = make_test_file ("small", 10);
+        var large = make_test_file ("large", 1000);
+
+        uint sized = 0;
+        var selection = new Files.SelectionSet ((file) => {
+            sized++;
+            return file.size;
+        });
+
+        var files = new GLib.List<Files.File> ();
+        files.append (folder);
+        files.append (small);
+        assert (selection.update (files));
+        assert (selection.count == 2);
+        assert (selection.folders_count == 1);
+        assert (selection.files_count == 1);
+        assert (selection.total_size == 10);
+        assert (sized == 1);
+
+        files.append (large);
+        assert (selection.update (files));
+        assert (selection.total_size == 1010);
+        assert (sized == 2); // Only the added file is sized
+        assert (!selection.update (files));
+
+        files.remove (folder);
+        files.remove (small);
+        assert (selection.update (files));
+        assert (selection.count == 1);
+        assert (!selection.contains (small));
+        assert (selection.folders_count == 0);
+        assert (selection.total_size == 1000);
+        assert (sized == 2);
+
+        assert (selection.remove (large));
+        assert (!selection.remove (large));
+        assert (selection.count == 0 && selection.files_count == 0 && selection.total_size == 0);
+
+        selection.add (small);
+        selection.clear ();
+        assert (selection.count == 0 && selection.total_size == 0);
+    });
+
+    Test.add_func ("/SelectionSet/content_types", () => {
+        var folder = make_test_file ("types-folder", -1);
+        var first = make_test_file ("types-first", 10);
+        var second = make_test_file ("types-second", 20);
+        var selection = new Files.SelectionSet ();
+
+        selection.add (first);
+        selection.add (second);
+        assert (selection.get_content_types ().length == 1);
+        assert (selection.get_content_types ()[0] == first.content_type);
+
+        selection.add (folder);
+        var types = selection.get_content_types ();
+        assert (types.length == 2);
+        assert (strcmp (types[0], types[1]) < 0);
+
+        selection.remove (first);
+        assert (selection.get_content_types ().length == 2);
+        selection.remove (second);
+        assert (selection.get_content_types ().length == 1);
+        assert (selection.get_content_types ()[0] == folder.content_type);
+
+        selection.clear ();
+        assert (selection.get_content_types ().length == 0);
+    });
+}
+
+int main (string[] args) {
+    Test.init (ref args);
+
+    test_dir_path = DirUtils.mkdtemp (Path.build_filename (Environment.get_tmp_dir (), "selection-set-XXXXXX"));
+    add_selection_set_tests ();
+    return Test.run ();
+}
@@ -37,9 +37,12 @@ valac --pkg sqlite3 --pkg gio-2.0 -o sqlitesample marlin_tagging.vala && ./sqlit
  * transparent transfer of data */
 [DBus (name = "io.elementary.files.db")]
 public class MarlinTags : Object {
-    private const string CMD = "INSERT OR REPLACE INTO tags (uri, content_type, color, modified_time, dir) " +
-                               "VALUES ('%s', '%s', %s, %s, '%s');\n";
     protected static Sqlite.Database db;
+    /* Prepared once when the database is opened and reset before each use */
+    private static Sqlite.Statement? insert_stmt = null;
+    private static Sqlite.Statement? select_stmt = null;
+    private static Sqlite.Statement? delete_stmt = null;
+    private static Sqlite.Statement? select_dir_stmt = null;
 
     public MarlinTags () {
         try {
@@ -98,6 +101,13 @@ public class MarlinTags : Object {
             warning ("Unable to disable synchronous mode %d, %s\n", rc, db.errmsg ());
         }
 
+        /* Readers are not blocked by writes and each transaction appends to the log instead of rewriting pages */
+        rc = db.exec ("PRAGMA journal_mode=WAL");
+
+        if (rc != Sqlite.OK) {
+            warning ("Unable to enable write-ahead logging %d, %s\n", rc, db.errmsg ());
+        }
+
         Sqlite.Statement stmt;
         int res = db.prepare_v2 ("CREATE TABLE IF NOT EXISTS tags ("
                                 + "id INTEGER PRIMARY KEY, "
@@ -119,32 +129,116 @@ public class MarlinTags : Object {
         /* TODO check result of the last sql command */
         upgrade_database ();
 
+        /* Covers the columns returned by get_dir_infos so that the table itself is not read */
+        rc = db.exec ("DROP INDEX IF EXISTS tags_dir_index;" +
+                      "CREATE INDEX IF NOT EXISTS tags_dir_covering_index ON tags (dir, uri, modified_time, color)");
+
+        if (rc != Sqlite.OK) {
+            warning ("Unable to create index on dir %d, %s\n", rc, db.errmsg ());
+        }
+
+        insert_stmt = prepare ("INSERT OR REPLACE INTO tags (uri, content_type, color, modified_time, dir) " +
+                               "VALUES (?, ?, ?, ?, ?)");
+        select_stmt = prepare ("SELECT modified_time, content_type, color FROM tags WHERE uri = ?");
+        delete_stmt = prepare ("DELETE FROM tags WHERE uri = ?");
+        select_dir_stmt = prepare ("SELECT uri, modified_time, color FROM tags WHERE dir = ?");
+
+        return true;
+    }
+
+    private static Sqlite.Statement prepare (string sql) {
+        Sqlite.Statement stmt;
+        int res = db.prepare_v2 (sql, -1, out stmt);
+
+        if (res != Sqlite.OK) {
+            fatal ("prepare %s".printf (sql), res);
+        }
+
+        return stmt;
+    }
+
+    /* Each batch is written in one transaction rather than one per statement */
+    private static void begin_transaction () {
+        int rc = db.exec ("BEGIN IMMEDIATE TRANSACTION");
+
+        if (rc != Sqlite.OK) {
+            warning ("[begin_transaction: SQL error]  %d, %s\n", rc, db.errmsg ());
+        }
+    }
+
+    private static void end_transaction (bool success) {
+        int rc = db.exec (success ? "COMMIT" : "ROLLBACK");
+
+        if (rc != Sqlite.OK) {
+            warning ("[end_transaction: SQL error]  %d, %s\n", rc, db.errmsg ());
+        }
+    }
+
+    /* Reads the entry of @raw_uri, returning false if there is none. The statement is reset before returning so
+     * that it does not keep a read transaction open, which would stop the WAL from being checkpointed. */
+    private bool select_uri (string raw_uri, out string? modified_time, out string? content_type,
+                             out string? color) {
+        modified_time = null;
+        content_type = null;
+        color = null;
+        select_stmt.bind_text (1, escape (raw_uri));
+        int rc = select_stmt.step ();
+
+        if (rc == Sqlite.ROW) {
+            modified_time = select_stmt.column_text (0);
+            content_type = select_stmt.column_text (1);
+            color = select_stmt.column_text (2);
+        } else if (rc != Sqlite.DONE) {
+            warning ("[select_uri]: Error: %d, %s\n", rc, db.errmsg ());
+        }
+
+        select_stmt.reset ();
+        select_stmt.clear_bindings ();
+        return rc == Sqlite.ROW;
+    }
+
+    private bool delete_uri (string raw_uri) {
+        delete_stmt.reset ();
+        delete_stmt.bind_text (1, escape (raw_uri));
+        int rc = delete_stmt.step ();
+
+        if (rc != Sqlite.DONE) {
+            warning ("[delete_uri: SQL error]  %d, %s\n", rc, db.errmsg ());
+            return false;
+        }
+
         return true;
     }
 
     public async bool record_uris (Variant[] locations) throws GLib.DBusError, GLib.IOError {
-        var sql = "";
+        var success = true;
+        begin_transaction ();
 
         foreach (var location_variant in locations) {
             VariantIter iter = location_variant.iterator ();
 
             var raw_uri = iter.next_value ().get_string ();
-            var uri = escape (raw_uri);
-            var directory = escape (Files.FileUtils.get_parent_path_from_path (raw_uri));
             var content_type = iter.next_value ().get_string ();
             var modified_time = iter.next_value ().get_string ();
             var color = iter.next_value ().get_string ();
-            sql += CMD.printf (uri, content_type, color, modified_time, directory);
-        }
-
-        int rc = db.exec (sql, null, null);
 
-        if (rc != Sqlite.OK) {
-            warning ("[record_uri: SQL error]  %d, %s, %s\n", rc, sql, db.errmsg ());
-            return false;
+            insert_stmt.reset ();
+            insert_stmt.bind_text (1, escape (raw_uri));
+            insert_stmt.bind_text (2, content_type);
+            insert_stmt.bind_int64 (3, int64.parse (color));
+            insert_stmt.bind_int64 (4, int64.parse (modified_time));
+            insert_stmt.bind_text (5, escape (Files.FileUtils.get_parent_path_from_path (raw_uri)));
+            int rc = insert_stmt.step ();
+
+            if (rc != Sqlite.DONE) {
+                warning ("[record_uri: SQL error]  %d, %s, %s\n", rc, raw_uri, db.errmsg ());
+                success = false;
+                break;
+            }
         }
 
-        return true;
+        end_transaction (success);
+        return success;
     }
 
     private string escape (string input) {
@@ -154,28 +248,15 @@ public class MarlinTags : Object {
     public async Variant get_uri_infos (string raw_uri) throws GLib.DBusError, GLib.IOError {
         Idle.add (get_uri_infos.callback);
         yield;
-        var uri = escape (raw_uri);
-        Sqlite.Statement stmt;
 
         var vb = new VariantBuilder (new VariantType ("(as)"));
-        int rc = db.prepare_v2 ("select modified_time, content_type, color from tags where uri='%s'".printf (uri),
-                                -1, out stmt);
-        assert (rc == Sqlite.OK);
-        rc = stmt.step ();
         vb.open (new VariantType ("as"));
 
-        switch (rc) {
-        case Sqlite.DONE:
-            break;
-        case Sqlite.ROW:
-            vb.add ("s", stmt.column_text (0));
-            var content_type = stmt.column_text (1);
+        string? modified_time, content_type, color;
+        if (select_uri (raw_uri, out modified_time, out content_type, out color)) {
+            vb.add ("s", modified_time);
             vb.add ("s", (content_type != null) ? content_type : "");
-            vb.add ("s", stmt.column_text (2));
-            break;
-        default:
-            warning ("[get_uri_infos]: Error: %d, %s\n", rc, db.errmsg ());
-            break;
+            vb.add ("s", color);
         }
 
         vb.close ();
@@ -185,15 +266,66 @@ public class MarlinTags : Object {
     public async bool delete_entry (string uri) throws GLib.DBusError, GLib.IOError {
         Idle.add (delete_entry.callback);
         yield;
-        string c = "delete from tags where uri='" + uri + "'";
-        int rc = db.exec (c, null, null);
+        return delete_uri (uri);
+    }
 
-        if (rc != Sqlite.OK) {
-            warning ("[delete_entry: SQL error]  %d, %s\n", rc, db.errmsg ());
-            return false;
+    /* Returns (uri, modified_time, content_type, color) for each of @raw_uris that has an entry */
+    public async Variant get_uri_infos_batch (string[] raw_uris) throws GLib.DBusError, GLib.IOError {
+        Idle.add (get_uri_infos_batch.callback);
+        yield;
+
+        var vb = new VariantBuilder (new VariantType ("a(ssss)"));
+        foreach (unowned var raw_uri in raw_uris) {
+            string? modified_time, content_type, color;
+            if (select_uri (raw_uri, out modified_time, out content_type, out color)) {
+                vb.add ("(ssss)", raw_uri, modified_time ?? "0", content_type ?? "", color ?? "0");
+            }
         }
 
-        return true;
+        return vb.end ();
+    }
+
+    /* Returns (uri, modified_time, color) for each entry of a file in @dir_uri */
+    public async Variant get_dir_infos (string dir_uri) throws GLib.DBusError, GLib.IOError {
+        Idle.add (get_dir_infos.callback);
+        yield;
+
+        /* The stored dir is derived from the uri of each file, so derive it in the same way */
+        var child_uri = Path.build_path (Path.DIR_SEPARATOR_S, dir_uri, "_");
+        select_dir_stmt.reset ();
+        select_dir_stmt.bind_text (1, escape (Files.FileUtils.get_parent_path_from_path (child_uri)));
+
+        var vb = new VariantBuilder (new VariantType ("a(sss)"));
+        int rc;
+        while ((rc = select_dir_stmt.step ()) == Sqlite.ROW) {
+            vb.add ("(sss)", select_dir_stmt.column_text (0), select_dir_stmt.column_text (1) ?? "0",
+                    select_dir_stmt.column_text (2) ?? "0");
+        }
+
+        if (rc != Sqlite.DONE) {
+            warning ("[get_dir_infos]: Error: %d, %s\n", rc, db.errmsg ());
+        }
+
+        select_dir_stmt.reset ();
+        select_dir_stmt.clear_bindings ();
+        return vb.end ();
+    }
+
+    public async bool delete_entries (string[] raw_uris) throws GLib.DBusError, GLib.IOError {
+        Idle.add (delete_entries.callback);
+        yield;
+
+        var success = true;
+        begin_transaction ();
+        foreach (unowned var raw_uri in raw_uris) {
+            if (!delete_uri (raw_uri)) {
+                success = false;
+                break;
+            }
+        }
+
+        end_transaction (success);
+        return success;
     }
 
 /************* Used for maintenance only *************/
@@ -21,14 +21,33 @@
     with this program.  If not, see <http://www.gnu.org/licenses/>.
 ***/
 
+/* Contracts are looked up for the set of content types of the files in the menu. The contracts for each set are
+ * remembered, until the contractor service reports that the contracts have changed, so that the menu for a
+ * selection like an earlier one does not wait for the service.
+ */
 public class Files.Plugins.Contractor : Files.Plugins.Base {
     private Gtk.Menu menu;
     private Files.File current_directory = null;
+    /* Contracts keyed by the sorted content types they were looked up for */
+    private Gee.HashMap<string, Gee.List<Granite.Services.Contract>> contracts_cache;
 
     public Contractor () {
+        contracts_cache = new Gee.HashMap<string, Gee.List<Granite.Services.Contract>> ();
+        try {
+            Granite.Services.ContractorProxy.get_instance ().contracts_changed.connect (() => {
+                contracts_cache.clear ();
+            });
+        } catch (Error e) {
+            warning ("Contracts will not be cached: %s", e.message);
+        }
     }
 
     public override void context_menu (Gtk.Widget widget, List<Files.File> gof_files) {
+        context_menu_for_selection (widget, gof_files, null);
+    }
+
+    public override void context_menu_for_selection (Gtk.Widget widget, List<Files.File> gof_files,
+                                                     Files.SelectionSet? selection) {
         menu = widget as Gtk.Menu;
 
         GLib.File[] files = null;
@@ -49,21 +68,28 @@ public class Files.Plugins.Contractor : Files.Plugins.Base {
                     return;
                 }
 
-                contracts = Granite.Services.ContractorProxy.get_contracts_by_mime (mimetype);
+                contracts = get_contracts ({ mimetype });
             } else {
-                files = get_file_array (gof_files);
-                var mimetypes = get_mimetypes (gof_files);
+                string[] mimetypes;
+                if (selection != null) {
+                    mimetypes = selection.get_content_types ();
+                } else {
+                    mimetypes = get_mimetypes (gof_files);
+                }
+
                 if (mimetypes.length > 0) {
-                    contracts = Granite.Services.ContractorProxy.get_contracts_by_mimelist (mimetypes);
+                    contracts = get_contracts (mimetypes);
                 }
             }
 
-            assert (files != null);
-
-            if (contracts == null) {
+            if (contracts == null || contracts.size == 0) {
                 return;
             }
 
+            if (files == null) {
+                files = get_file_array (gof_files);
+            }
+
             var separator_item = new Gtk.SeparatorMenuItem ();
             add_menuitem (menu, separator_item);
 
@@ -96,6 +122,27 @@ public class Files.Plugins.Contractor : Files.Plugins.Base {
         }
     }
 
+    /* @mimetypes must be sorted and without duplicates */
+    private Gee.List<Granite.Services.Contract> get_contracts (string[] mimetypes) throws Error {
+        var key = string.joinv (";", mimetypes);
+        var contracts = contracts_cache[key];
+        if (contracts == null) {
+            if (mimetypes.length == 1) {
+                contracts = Granite.Services.ContractorProxy.get_contracts_by_mime (mimetypes[0]);
+            } else {
+                contracts = Granite.Services.ContractorProxy.get_contracts_by_mimelist (mimetypes);
+            }
+
+            if (contracts == null) {
+                contracts = new Gee.ArrayList<Granite.Services.Contract> ();
+            }
+
+            contracts_cache[key] = contracts;
+        }
+
+        return contracts;
+    }
+
     public override void directory_loaded (Gtk.ApplicationWindow window, Files.AbstractSlot view, Files.File directory) {
         current_directory = directory;
     }
@@ -106,18 +153,19 @@ public class Files.Plugins.Contractor : Files.Plugins.Base {
         plugins.menuitem_references.add (menu_item);
     }
 
+    /* The sorted content types of @files without duplicates, for when the view did not provide them */
     private static string[] get_mimetypes (List<Files.File> files) {
-        string[] mimetypes = new string[0];
+        var unique = new Gee.TreeSet<string> ();
 
         foreach (unowned Files.File file in files) {
             var ftype = file.content_type;
 
             if (ftype != null) {
-                mimetypes += ftype;
+                unique.add (ftype);
             }
         }
 
-        return mimetypes;
+        return unique.to_array ();
     }
 
     private static GLib.File[] get_file_array (List<Files.File> files) {
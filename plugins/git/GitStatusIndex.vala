@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/* The status of the paths in a repository arranged as a tree of path components. Each node also holds the status of
+ * all the paths below it combined, so that the status of a file or of anything in a folder is found by following
+ * the components of its path instead of scanning every path with a status.
+ */
+public class Files.GitStatusIndex {
+    [Compact]
+    private class Node {
+        public HashTable<string, Node>? children = null;
+        /* The status of this path, if it has one */
+        public Ggit.StatusFlags status = Ggit.StatusFlags.CURRENT;
+        /* The status of this path and all paths below it */
+        public Ggit.StatusFlags combined = Ggit.StatusFlags.CURRENT;
+
+        public unowned Node get_or_add_child (string name) {
+            if (children == null) {
+                children = new HashTable<string, Node> (str_hash, str_equal);
+            }
+
+            unowned var child = children.lookup (name);
+            if (child == null) {
+                var new_child = new Node ();
+                child = new_child;
+                children.insert (name, (owned) new_child);
+            }
+
+            return child;
+        }
+    }
+
+    private Node root;
+
+    public uint size { get; private set; default = 0; }
+
+    public GitStatusIndex () {
+        root = new Node ();
+    }
+
+    /* @path is relative to the working directory. Untracked folders are reported by git with a trailing separator. */
+    public void insert (string path, Ggit.StatusFlags status) {
+        unowned var node = root;
+        node.combined |= status;
+        foreach (unowned var name in path.split (Path.DIR_SEPARATOR_S)) {
+            if (name != "") {
+                node = node.get_or_add_child (name);
+                node.combined |= status;
+            }
+        }
+
+        node.status |= status;
+        size++;
+    }
+
+    /* Returns the status of @path combined with that of every path below it, or CURRENT if none has a status */
+    public Ggit.StatusFlags lookup (string path) {
+        unowned var node = root;
+        foreach (unowned var name in path.split (Path.DIR_SEPARATOR_S)) {
+            if (name == "") {
+                continue;
+            }
+
+            if (node.children == null) {
+                return node.status;
+            }
+
+            unowned var child = node.children.lookup (name);
+            if (child == null) {
+                /* Paths in an untracked folder share its status */
+                return node.status;
+            }
+
+            node = child;
+        }
+
+        return node.combined;
+    }
+}
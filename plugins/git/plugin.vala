@@ -16,57 +16,194 @@
     Authors : Jeremy Wootten <jeremywootten@gmail.com>
 ***/
 
+    /* The status of a repository, listed on a worker thread for each folder shown. The status of a folder is kept
+     * until the index or HEAD of the repository is modified.
+     */
     public class Files.GitRepoInfo : Object {
-        public Ggit.Repository repo { get; construct; }
-        public HashTable<string, Ggit.StatusFlags> status_map { get; construct; }
-        static Ggit.StatusOptions status_options;
+        public GLib.File gitdir { get; construct; }
+        public GLib.File workdir { get; private set; }
 
-        static construct {
-            status_options = new Ggit.StatusOptions (Ggit.StatusOption.DEFAULT,
-                                                     Ggit.StatusShow.INDEX_AND_WORKDIR,
-                                                     {});
-        }
+        /* Emitted when listing the status below @rel_path has finished, successfully or not */
+        public signal void status_ready (string rel_path);
+
+        /* Status indexes of folders relative to the working directory, with "" for the whole repository */
+        private HashTable<string, Files.GitStatusIndex> indexes;
+        private GLib.GenericSet<string> pending_paths;
+        private bool is_listing = false;
+        private uint generation = 0;
+
+        /* The modification times of the index and HEAD when the indexes were listed */
+        private uint64 index_mtime = 0;
+        private uint64 head_mtime = 0;
+
+        /* Only used by one worker thread at a time */
+        private Ggit.Repository? worker_repo = null;
 
         construct {
-            status_map = new HashTable<string, Ggit.StatusFlags> (str_hash, str_equal);
-            get_status_list ();
+            workdir = gitdir.get_parent ();
+            indexes = new HashTable<string, Files.GitStatusIndex> (str_hash, str_equal);
+            pending_paths = new GLib.GenericSet<string> (str_hash, str_equal);
         }
 
-        public GitRepoInfo (Ggit.Repository _repo) {
-            Object (repo: _repo);
+        public GitRepoInfo (GLib.File _gitdir) {
+            Object (gitdir: _gitdir);
+        }
+
+        /* Returns true if the status below @rel_path is known. Otherwise it is listed in the background and
+         * status_ready is emitted when done. */
+        public bool request_status (string rel_path) {
+            check_modified ();
+            if (find_index (rel_path) != null) {
+                return true;
+            }
+
+            pending_paths.add (rel_path);
+            if (!is_listing) {
+                list_pending.begin ();
+            }
 
+            return false;
         }
 
-        public bool get_status_list () {
-            status_map.remove_all ();
+        /* The status below @rel_path is listed again by the next request, e.g. because a file in it changed. The
+         * indexes of the folders above it are forgotten too as they combine its status. */
+        public void forget (string rel_path) {
+            var prefix = rel_path;
+            while (true) {
+                indexes.remove (prefix);
+                if (prefix == "") {
+                    break;
+                }
+
+                var separator = prefix.slice (0, prefix.length - 1).last_index_of_char (Path.DIR_SEPARATOR);
+                prefix = separator < 0 ? "" : prefix.substring (0, separator + 1);
+            }
+
+            /* Listings already running may have read the files before they changed */
+            generation++;
+        }
+
+        /* Returns the status of @path combined with that of the paths below it, or null if not yet known */
+        public Ggit.StatusFlags? lookup_status (string path) {
+            unowned var index = find_index (path);
+            return index != null ? index.lookup (path) : null;
+        }
 
+        /* The index of the folder containing @path or of the nearest folder above it that was listed */
+        private unowned Files.GitStatusIndex? find_index (string path) {
+            var prefix = path;
+            while (true) {
+                unowned var index = indexes.lookup (prefix);
+                if (index != null || prefix == "") {
+                    return index;
+                }
+
+                var separator = prefix.slice (0, prefix.length - 1).last_index_of_char (Path.DIR_SEPARATOR);
+                prefix = separator < 0 ? "" : prefix.substring (0, separator + 1);
+            }
+        }
+
+        /* Forgets all indexes if the index or HEAD changed since they were listed. Changes to the working tree are
+         * found through forget (). */
+        private void check_modified () {
+            var new_index_mtime = get_mtime ("index");
+            var new_head_mtime = get_mtime ("HEAD");
+            if (new_index_mtime == index_mtime && new_head_mtime == head_mtime) {
+                return;
+            }
+
+            index_mtime = new_index_mtime;
+            head_mtime = new_head_mtime;
+            indexes.remove_all ();
+            generation++;
+        }
+
+        private async void list_pending () {
+            is_listing = true;
+            while (pending_paths.length > 0) {
+                var rel_paths = new GLib.GenericArray<string> ();
+                pending_paths.foreach ((rel_path) => {
+                    rel_paths.add (rel_path);
+                });
+
+                pending_paths.remove_all ();
+
+                var listed_generation = generation;
+                var new_indexes = new GLib.GenericArray<Files.GitStatusIndex?> ();
+                new GLib.Thread<bool> ("git-status", () => {
+                    foreach (unowned var rel_path in rel_paths) {
+                        new_indexes.add (list_status (rel_path));
+                    }
+
+                    GLib.Idle.add (list_pending.callback);
+                    return true;
+                });
+
+                yield;
+
+                for (uint i = 0; i < rel_paths.length; i++) {
+                    if (listed_generation != generation) {
+                        /* Listed before the repository changed */
+                        pending_paths.add (rel_paths[i]);
+                        continue;
+                    }
+
+                    if (new_indexes[i] != null) {
+                        indexes.insert (rel_paths[i], new_indexes[i]);
+                    }
+
+                    status_ready (rel_paths[i]);
+                }
+            }
+
+            is_listing = false;
+        }
+
+        /* Called on the worker thread. Only paths below @rel_path are compared with the index and HEAD. */
+        private Files.GitStatusIndex? list_status (string rel_path) {
+            var index = new Files.GitStatusIndex ();
             try {
-                repo.file_status_foreach (status_options,
-                                          (path, status_flags) => {
+                if (worker_repo == null) {
+                    worker_repo = Ggit.Repository.open (gitdir);
+                }
 
+                string[] pathspec = {};
+                if (rel_path != "") {
+                    pathspec += rel_path.slice (0, rel_path.length - 1); // Without the trailing separator
+                }
+
+                var options = new Ggit.StatusOptions (
+                    Ggit.StatusOption.DEFAULT | Ggit.StatusOption.DISABLE_PATHSPEC_MATCH,
+                    Ggit.StatusShow.INDEX_AND_WORKDIR,
+                    pathspec
+                );
+
+                worker_repo.file_status_foreach (options, (path, status_flags) => {
                     if (!(Ggit.StatusFlags.IGNORED in status_flags)) {
-                        status_map.insert (path, status_flags);
+                        index.insert (path, status_flags);
                     }
 
                     return 0;
                 });
             } catch (Error e) {
                 warning ("Error getting status: %s", e.message);
-                return false;
+                return null;
             }
 
-            return true;
+            return index;
         }
 
-        public Ggit.StatusFlags? lookup_status (string path) {
-            var result = Ggit.StatusFlags.CURRENT;
-            status_map.@foreach ((k, v) => {
-                if (k.has_prefix (path)) {
-                    result = v;
-                }
-            });
-
-            return result;
+        /* Returns 0 if the file in the git directory cannot be queried */
+        private uint64 get_mtime (string name) {
+            try {
+                var info = gitdir.get_child (name).query_info (FileAttribute.TIME_MODIFIED + "," +
+                                                               FileAttribute.TIME_MODIFIED_USEC,
+                                                               FileQueryInfoFlags.NONE);
+                return info.get_attribute_uint64 (FileAttribute.TIME_MODIFIED) * 1000000 +
+                       info.get_attribute_uint32 (FileAttribute.TIME_MODIFIED_USEC);
+            } catch (Error e) {
+                return 0;
+            }
         }
     }
 
@@ -80,10 +217,15 @@ public class Files.Plugins.Git : Files.Plugins.Base {
     private const string EXCLUDED_FS_TYPES = "fuse"; // Filesystems such sshfs and ntfs return this type
     private HashTable<string, Files.GitRepoInfo?> repo_map;
     private HashTable<string, Files.GitRepoChildInfo?> child_map;
+    /* Folders shown in which files changed, keyed by uri, whose status is listed again after a delay */
+    private HashTable<string, Files.Directory> dirs_to_refresh;
+    private uint refresh_timeout_id = 0;
+    private const uint REFRESH_DELAY_MSEC = 500;
 
     public Git () {
         repo_map = new GLib.HashTable<string, Files.GitRepoInfo?> (str_hash, str_equal);
         child_map = new HashTable<string, Files.GitRepoChildInfo?> (str_hash, str_equal);
+        dirs_to_refresh = new HashTable<string, Files.Directory> (str_hash, str_equal);
     }
 
     public override void directory_loaded (Gtk.ApplicationWindow window, Files.AbstractSlot view, Files.File directory) {
@@ -124,55 +266,184 @@ public class Files.Plugins.Git : Files.Plugins.Base {
             return;
         }
 
-        var dir_uri = directory.uri;
-        var repo_uri = "";
+        if (directory.location.get_path () == null) { //e.g. for network://
+            return;
+        }
+
+        show_status.begin (view.directory);
+    }
 
-        try {
-            var key = directory.location;
-            if (key.get_path () == null) { //e.g. for network://
+    /* Finds the repository and its status on worker threads then adds emblems to the files already shown */
+    private async void show_status (Files.Directory dir) {
+        var dir_uri = dir.file.uri;
+        var child_info = child_map.lookup (dir_uri);
+        if (child_info == null) {
+            GLib.File? gitdir = null;
+            var location = dir.location;
+            new GLib.Thread<bool> ("git-discover", () => {
+                try {
+                    gitdir = Ggit.Repository.discover (location);
+                } catch (Error e) {
+                    /* An error is normal if the directory is not a git repo */
+                    debug ("Error opening git repository at %s: %s", dir_uri, e.message);
+                }
+
+                GLib.Idle.add (show_status.callback);
+                return true;
+            });
+
+            yield;
+
+            if (gitdir == null) {
                 return;
             }
 
-            var gitdir = Ggit.Repository.discover (key);
-            if (gitdir != null) {
-                repo_uri = gitdir.get_uri ();
-                Files.GitRepoInfo? repo_info = repo_map.lookup (repo_uri);
-                if (repo_info == null) {
-                    var git_repo = Ggit.Repository.open (gitdir);
-                    repo_info = new Files.GitRepoInfo (git_repo);
-                    repo_map.insert (repo_uri, repo_info);
-                } else {
-                    repo_info.get_status_list ();
-                }
+            var repo_uri = gitdir.get_uri ();
+            Files.GitRepoInfo? repo_info = repo_map.lookup (repo_uri);
+            if (repo_info == null) {
+                repo_info = new Files.GitRepoInfo (gitdir);
+                repo_map.insert (repo_uri, repo_info);
+            }
 
-                if (!child_map.contains (dir_uri)) {
-                    var rel_path = repo_info.repo.location.get_parent ().get_relative_path (directory.location);
-                    if (rel_path != null) {
-                        rel_path = rel_path + Path.DIR_SEPARATOR_S;
-                    } else {
-                        rel_path = "";
-                    }
-                    Files.GitRepoChildInfo child_info = { repo_uri, rel_path };
-                    child_map.insert (dir_uri, child_info);
-                } else {
+            var rel_path = repo_info.workdir.get_relative_path (location);
+            if (rel_path != null) {
+                rel_path = rel_path + Path.DIR_SEPARATOR_S;
+            } else {
+                rel_path = "";
+            }
+
+            Files.GitRepoChildInfo new_child_info = { repo_uri, rel_path };
+            child_map.insert (dir_uri, new_child_info);
+            child_info = new_child_info;
+        }
+
+        Files.GitRepoInfo? repo_info = repo_map.lookup (child_info.repo_uri);
+        if (repo_info == null) {
+            return;
+        }
+
+        /* Status is listed again when the index or HEAD is modified, or when files change in a folder shown */
+        if (!dir.get_data<bool> ("git-plugin-monitored")) {
+            dir.set_data<bool> ("git-plugin-monitored", true);
+            dir.file_added.connect (on_file_added);
+            dir.file_changed.connect (on_file_changed);
+            dir.file_deleted.connect (on_file_changed);
+        }
+
+        yield wait_for_status (repo_info, child_info.rel_path);
+
+        foreach (unowned var file in dir.get_files ()) {
+            update_file_info (file);
+        }
+    }
+
+    private async void wait_for_status (Files.GitRepoInfo repo_info, string rel_path) {
+        if (repo_info.request_status (rel_path)) {
+            return;
+        }
+
+        var ready = false;
+        var handler = repo_info.status_ready.connect ((listed_path) => {
+            if (listed_path == rel_path && !ready) {
+                ready = true;
+                GLib.Idle.add (wait_for_status.callback);
+            }
+        });
+
+        yield;
+        repo_info.disconnect (handler);
+    }
+
+    private void on_file_added (Files.File? file, bool is_internal) {
+        if (file != null) {
+            on_file_changed (file);
+        }
+    }
+
+    private void on_file_changed (Files.File file) {
+        if (file.directory == null) {
+            return;
+        }
+
+        var dir = Files.Directory.cache_lookup (file.directory);
+        if (dir == null) {
+            return;
+        }
+
+        dirs_to_refresh.insert (dir.file.uri, dir);
+        if (refresh_timeout_id == 0) {
+            refresh_timeout_id = GLib.Timeout.add (REFRESH_DELAY_MSEC, () => {
+                refresh_timeout_id = 0;
+                foreach (unowned var refreshed_dir in dirs_to_refresh.get_values ()) {
+                    refresh_status.begin (refreshed_dir);
                 }
+
+                dirs_to_refresh.remove_all ();
+                return GLib.Source.REMOVE;
+            });
+        }
+    }
+
+    /* Lists the status of a folder shown again and updates the emblems of the files whose status changed */
+    private async void refresh_status (Files.Directory dir) {
+        var child_info = child_map.lookup (dir.file.uri);
+        if (child_info == null) {
+            return;
+        }
+
+        Files.GitRepoInfo? repo_info = repo_map.lookup (child_info.repo_uri);
+        if (repo_info == null) {
+            return;
+        }
+
+        var old_emblems = new HashTable<Files.File, string> (direct_hash, direct_equal);
+        foreach (unowned var file in dir.get_files ()) {
+            var emblem = get_emblem (file);
+            if (emblem != null) {
+                old_emblems.insert (file, emblem);
+            }
+        }
+
+        repo_info.forget (child_info.rel_path);
+        yield wait_for_status (repo_info, child_info.rel_path);
+
+        foreach (unowned var file in dir.get_files ()) {
+            var old_emblem = old_emblems.lookup (file);
+            var emblem = get_emblem (file);
+            if (emblem == old_emblem) {
+                continue;
+            }
+
+            if (old_emblem != null) {
+                /* Emblems cannot be removed singly so all are added again */
+                file.update_emblem ();
+                plugins.update_file_info (file);
+                /* Shows the emblem being removed, adding one updates the view anyway */
+                dir.icon_changed (file);
+            } else {
+                file.add_emblem (emblem);
             }
-        } catch (Error e) {
-            /* An error is normal if the directory is not a git repo */
-            debug ("Error opening git repository at %s: %s", directory.uri, e.message);
         }
     }
 
     public override void update_file_info (Files.File gof) {
+        var emblem = get_emblem (gof);
+        if (emblem != null) {
+            gof.add_emblem (emblem);
+        }
+    }
+
+    /* The emblem for the status of @gof, or null if it has none or its status is not yet known */
+    private string? get_emblem (Files.File gof) {
         /* Ignore e.g. .git and .github folders, but include e.g. .travis.yml file */
         //TODO Rely on .gitignore to exclude unwanted tracking
         if (gof.is_hidden && gof.is_directory) {
-            return;
+            return null;
         }
 
         var child_info = child_map.lookup (gof.directory.get_uri ());
         if (child_info == null) {
-            return;
+            return null;
         }
 
         Files.GitRepoInfo? repo_info = repo_map.lookup (child_info.repo_uri);
@@ -180,30 +451,26 @@ public class Files.Plugins.Git : Files.Plugins.Base {
         if (repo_info != null) {
             var rel_path = child_info.rel_path + gof.basename;
             if (rel_path != null) {
+                /* Null until the status has been listed, when emblems are added to the files shown */
                 var git_status = repo_info.lookup_status (rel_path);
-                if (git_status != null) {
-                    switch (git_status) {
-                        case Ggit.StatusFlags.CURRENT:
-                            break;
-
-                        case Ggit.StatusFlags.INDEX_MODIFIED:
-                        case Ggit.StatusFlags.WORKING_TREE_MODIFIED:
-                            gof.add_emblem ("emblem-git-modified");
-                            break;
-
-                        case Ggit.StatusFlags.WORKING_TREE_NEW:
-                            gof.add_emblem ("emblem-git-new");
-                            break;
-
-                        default:
-                            warning ("unhandled status %s", git_status.to_string ());
-                            break;
+                if (git_status != null && git_status != Ggit.StatusFlags.CURRENT) {
+                    /* Folders combine the status of everything in them */
+                    if ((Ggit.StatusFlags.INDEX_MODIFIED in git_status) ||
+                        (Ggit.StatusFlags.WORKING_TREE_MODIFIED in git_status)) {
+
+                        return "emblem-git-modified";
+                    } else if (Ggit.StatusFlags.WORKING_TREE_NEW in git_status) {
+                        return "emblem-git-new";
+                    } else {
+                        debug ("unhandled status %s", git_status.to_string ());
                     }
                 }
             } else {
                 critical ("Git plugin update_file_info: Relative path is null");
             }
         }
+
+        return null;
     }
 }
 
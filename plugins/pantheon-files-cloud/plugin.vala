@@ -17,15 +17,25 @@
     Author(s):  Fernando da Silva Sousa <wild.nando@gmail.com>
 ***/
 
+/* Adds cloud provider accounts to the sidebar and shows the sync status of each account on its folder. The status
+ * of every account is followed through one subscription per account and kept by the path of its folder, so files
+ * are decorated without asking the provider anything.
+ */
 public class Files.Plugins.Cloud.Plugin : Files.Plugins.Base {
     Files.SidebarInterface? sidebar;
     CloudProviders.Collector collector;
     GLib.GenericArray<CloudProviders.Provider> providers_connected;
+    GLib.GenericArray<CloudProviders.Account> accounts_watched;
+    /* The status of each account keyed by the path of its folder */
+    GLib.HashTable<string, CloudProviders.AccountStatus> account_statuses;
 
     public Plugin () {
         providers_connected = new GLib.GenericArray<CloudProviders.Provider> ();
+        accounts_watched = new GLib.GenericArray<CloudProviders.Account> ();
+        account_statuses = new GLib.HashTable<string, CloudProviders.AccountStatus> (str_hash, str_equal);
         collector = CloudProviders.Collector.dup_singleton ();
         collector.providers_changed.connect (on_providers_changes);
+        watch_accounts ();
     }
 
     /**
@@ -74,14 +84,106 @@ public class Files.Plugins.Cloud.Plugin : Files.Plugins.Base {
             }
         }
 
+        watch_accounts ();
         //  Request sidebar update to show new accounts
         request_sidebar_update ();
     }
 
     void on_accounts_changed () {
+        watch_accounts ();
         request_sidebar_update ();
     }
 
+    public override void update_file_info (Files.File file) {
+        if (account_statuses.size () == 0 || !file.is_directory) {
+            return;
+        }
+
+        var path = file.location.get_path ();
+        if (path == null) {
+            return;
+        }
+
+        switch (account_statuses.lookup (path)) {
+            case CloudProviders.AccountStatus.SYNCING:
+                file.add_emblem ("emblem-synchronizing");
+                break;
+            case CloudProviders.AccountStatus.ERROR:
+                file.add_emblem ("emblem-important");
+                break;
+            default:
+                break;
+        }
+    }
+
+    /* Follows the status of accounts added since last called and stops following those removed */
+    void watch_accounts () {
+        var accounts = new GLib.GenericArray<CloudProviders.Account> ();
+        foreach (unowned var provider in collector.get_providers ()) {
+            foreach (unowned var account in provider.get_accounts ()) {
+                accounts.add (account);
+                if (!accounts_watched.find (account)) {
+                    accounts_watched.add (account);
+                    account.notify["status"].connect (update_account_statuses);
+                    account.notify["path"].connect (update_account_statuses);
+                }
+            }
+        }
+
+        for (uint i = accounts_watched.length; i > 0; i--) {
+            unowned var account = accounts_watched[i - 1];
+            if (!accounts.find (account)) {
+                account.notify["status"].disconnect (update_account_statuses);
+                account.notify["path"].disconnect (update_account_statuses);
+                accounts_watched.remove_index_fast (i - 1);
+            }
+        }
+
+        update_account_statuses ();
+    }
+
+    /* Updates the emblems of the account folders whose status changed */
+    void update_account_statuses () {
+        var statuses = new GLib.HashTable<string, CloudProviders.AccountStatus> (str_hash, str_equal);
+        foreach (unowned var account in accounts_watched.data) {
+            if (account.path != null) {
+                statuses.insert (account.path, account.get_status ());
+            }
+        }
+
+        var changed = new GLib.GenericSet<string> (str_hash, str_equal);
+        statuses.foreach ((path, status) => {
+            if (account_statuses.lookup (path) != status) {
+                changed.add (path);
+            }
+        });
+
+        account_statuses.foreach ((path, status) => {
+            if (!(path in statuses)) {
+                changed.add (path);
+            }
+        });
+
+        account_statuses = statuses;
+        changed.foreach ((path) => {
+            Files.File? file = Files.File.cache_lookup (GLib.File.new_for_path (path));
+            if (file == null) {
+                return;
+            }
+
+            file.update_emblem ();
+            plugins.update_file_info (file);
+
+            /* Shows the emblem being removed, adding one updates the view anyway */
+            if (file.directory != null) {
+                var dir = Files.Directory.cache_lookup (file.directory);
+                if (dir != null) {
+                    dir.icon_changed (file);
+                }
+            }
+        });
+    }
+
     void request_sidebar_update () {
         if (sidebar == null) {
             return;
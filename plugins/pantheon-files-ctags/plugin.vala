@@ -20,17 +20,31 @@ interface MarlinDaemon : Object {
     public abstract async Variant get_uri_infos (string raw_uri) throws GLib.DBusError, GLib.IOError;
     public abstract async bool record_uris (Variant[] entries) throws GLib.DBusError, GLib.IOError;
     public abstract async bool delete_entry (string uri) throws GLib.DBusError, GLib.IOError;
+    public abstract async Variant get_uri_infos_batch (string[] raw_uris) throws GLib.DBusError, GLib.IOError;
+    public abstract async bool delete_entries (string[] raw_uris) throws GLib.DBusError, GLib.IOError;
+    public abstract async Variant get_dir_infos (string dir_uri) throws GLib.DBusError, GLib.IOError;
 
 }
 
 public class Files.Plugins.CTags : Files.Plugins.Base {
+    private const uint BATCH_DELAY_MSEC = 100;
+
     /* May be used by more than one directory simultaneously so do not make assumptions */
     private MarlinDaemon daemon;
     private Cancellable cancellable;
     private GLib.List<Files.File> current_selected_files;
+    /* Folders whose files have all been looked up in the daemon database, which no longer gains entries */
+    private GLib.GenericSet<string> migrated_dirs;
+    /* The files waiting to be looked up in the daemon database, by folder */
+    private GLib.HashTable<string, GLib.GenericSet<string>> pending_lookups;
+    private GLib.GenericSet<string> pending_deletions;
+    private uint batch_timeout_id = 0;
 
     public CTags () {
         cancellable = new Cancellable ();
+        migrated_dirs = new GLib.GenericSet<string> (str_hash, str_equal);
+        pending_lookups = new GLib.HashTable<string, GLib.GenericSet<string>> (str_hash, str_equal);
+        pending_deletions = new GLib.GenericSet<string> (str_hash, str_equal);
 
         try {
             daemon = Bus.get_proxy_sync (BusType.SESSION, "io.elementary.files.db",
@@ -41,32 +55,38 @@ public class Files.Plugins.CTags : Files.Plugins.Base {
     }
 
     private async void rreal_update_file_info (Files.File file) {
-        try {
-            if (!file.exists || file.color >= 0) {
-                // Delete the entry if file no longer exists or we obtained color info from metadata
-                yield daemon.delete_entry (file.uri);
-                return;
+        var dir_uri = file.directory != null ? file.directory.get_uri () : null;
+        var migrated = dir_uri == null || dir_uri in migrated_dirs;
+        if (!file.exists) {
+            // Delete the entry if file no longer exists
+            if (!migrated) {
+                pending_deletions.add (file.uri);
+                schedule_batch ();
+            }
+
+            return;
+        }
+
+        if (!migrated) {
+            // Look for color in Files daemon database together with the other files in the folder
+            var uris = pending_lookups.lookup (dir_uri);
+            if (uris == null) {
+                uris = new GLib.GenericSet<string> (str_hash, str_equal);
+                pending_lookups.insert (dir_uri, uris);
             }
 
+            uris.add (file.uri);
+            schedule_batch ();
+        }
+
+        if (file.color >= 0) {
+            return;
+        }
+
+        try {
             var info = yield file.location.query_info_async ("metadata::color-tag", FileQueryInfoFlags.NONE);
             if (info.has_attribute ("metadata::color-tag")) {
                 file.color = int.parse (info.get_attribute_string ("metadata::color-tag"));
-            } else {
-                // Look for color in Files daemon database
-                var rc = yield daemon.get_uri_infos (file.uri);
-
-                VariantIter iter = rc.iterator ();
-                assert (iter.n_children () == 1);
-                VariantIter row_iter = iter.next_value ().iterator ();
-
-                if (row_iter.n_children () == 3) {
-                    /* Only interested in color tag */
-                    int64.parse (row_iter.next_value ().get_string ()); // Skip modified date
-                    row_iter.next_value ().get_string (); // Skip file type
-                    file.color = int.parse (row_iter.next_value ().get_string ());
-                    file.location.set_attribute_string ("metadata::color-tag", file.color.to_string (), FileQueryInfoFlags.NONE);
-                    yield daemon.delete_entry (file.uri);
-                }
             }
         } catch (Error err) {
             warning ("%s", err.message);
@@ -79,6 +99,109 @@ public class Files.Plugins.CTags : Files.Plugins.Base {
         }
     }
 
+    public override void directory_loaded (Gtk.ApplicationWindow window, Files.AbstractSlot view, Files.File directory) {
+        var dir_uri = directory.uri;
+        if (!(dir_uri in migrated_dirs) && !(dir_uri in pending_lookups)) {
+            pending_lookups.insert (dir_uri, new GLib.GenericSet<string> (str_hash, str_equal));
+            schedule_batch ();
+        }
+    }
+
+    private void schedule_batch () {
+        if (batch_timeout_id == 0 && daemon != null) {
+            batch_timeout_id = GLib.Timeout.add (BATCH_DELAY_MSEC, () => {
+                batch_timeout_id = 0;
+                migrate_pending.begin ();
+                return GLib.Source.REMOVE;
+            });
+        }
+    }
+
+    /* Moves the colors of the pending files from the daemon database to file metadata with one lookup per folder
+     * and one deletion for all folders. Folders loaded in a view are looked up whole, with a single query of the
+     * daemon database by folder, and then not again. */
+    private async void migrate_pending () {
+        var lookups = (owned) pending_lookups;
+        pending_lookups = new GLib.HashTable<string, GLib.GenericSet<string>> (str_hash, str_equal);
+        string[] deletions = {};
+        pending_deletions.foreach ((uri) => {
+            deletions += uri;
+        });
+
+        pending_deletions.remove_all ();
+
+        var iter = GLib.HashTableIter<string, GLib.GenericSet<string>> (lookups);
+        unowned string dir_uri;
+        unowned GLib.GenericSet<string> pending_uris;
+        while (iter.next (out dir_uri, out pending_uris)) {
+            if (dir_uri in migrated_dirs) {
+                continue;
+            }
+
+            var dir = Files.Directory.cache_lookup (GLib.File.new_for_uri (dir_uri));
+            var whole_dir = dir != null && dir.is_loaded ();
+            try {
+                if (whole_dir) {
+                    var rows = yield daemon.get_dir_infos (dir_uri);
+                    migrated_dirs.add (dir_uri);
+                    foreach (var row in rows) {
+                        string uri, modified_time, color;
+                        row.get ("(sss)", out uri, out modified_time, out color);
+                        yield migrate_color (uri, int.parse (color));
+                        deletions += uri;
+                    }
+                } else {
+                    string[] uris = {};
+                    pending_uris.foreach ((uri) => {
+                        uris += uri;
+                    });
+
+                    if (uris.length == 0) {
+                        continue;
+                    }
+
+                    var rows = yield daemon.get_uri_infos_batch (uris);
+                    foreach (var row in rows) {
+                        string uri, modified_time, content_type, color;
+                        row.get ("(ssss)", out uri, out modified_time, out content_type, out color);
+                        yield migrate_color (uri, int.parse (color));
+                        deletions += uri;
+                    }
+                }
+            } catch (Error err) {
+                warning ("%s", err.message);
+            }
+        }
+
+        if (deletions.length > 0) {
+            try {
+                yield daemon.delete_entries (deletions);
+            } catch (Error err) {
+                warning ("%s", err.message);
+            }
+        }
+    }
+
+    /* Colors already in file metadata take precedence */
+    private async void migrate_color (string uri, int color) {
+        var file = Files.File.get_by_uri (uri);
+        if (file == null) {
+            return;
+        }
+
+        try {
+            var info = yield file.location.query_info_async ("metadata::color-tag", FileQueryInfoFlags.NONE);
+            if (info.has_attribute ("metadata::color-tag")) {
+                file.color = int.parse (info.get_attribute_string ("metadata::color-tag"));
+            } else {
+                file.color = color;
+                file.location.set_attribute_string ("metadata::color-tag", color.to_string (), FileQueryInfoFlags.NONE);
+            }
+        } catch (Error err) {
+            warning ("%s", err.message);
+        }
+    }
+
     public override void context_menu (Gtk.Widget widget, GLib.List<Files.File> selected_files) {
         if (selected_files == null) {
             return;
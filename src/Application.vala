@@ -34,6 +34,7 @@ public class Files.Application : Gtk.Application {
     private Progress.UIHandler progress_handler;
     private ClipboardManager clipboard;
     private Gtk.RecentManager recent;
+    private uint plugin_stats_id = 0;
 
     private const int MARLIN_ACCEL_MAP_SAVE_DELAY = 15;
     private const uint MAX_WINDOWS = 25;
@@ -72,6 +73,8 @@ public class Files.Application : Gtk.Application {
         add_main_option ("new-window", 'n', NONE, NONE, _("New Window"), null );
         add_main_option ("quit", 'q', NONE, NONE, _("Quit Files"), null );
         add_main_option ("debug", 'd', NONE, NONE, _("Enable debug logging"), null );
+        add_main_option ("plugin-stats", '\0', NONE, NONE,
+                         _("Show how long each plugin has been taking in the running instance"), null );
 
         // GLib.OPTION_REMAINING: Catches the remaining arguments
         add_main_option (GLib.OPTION_REMAINING, '\0', NONE, STRING_ARRAY, "\0", _("[URI…]") );
@@ -115,6 +118,33 @@ public class Files.Application : Gtk.Application {
             return Posix.EXIT_SUCCESS;
         }
 
+        if ("plugin-stats" in options) {
+            if (!remote) {
+                stderr.printf (_("Files is not running.") + "\n");
+                return Posix.EXIT_FAILURE;
+            }
+
+            try {
+                var reply = get_dbus_connection ().call_sync (
+                    application_id,
+                    get_dbus_object_path () + PluginStatsService.OBJECT_PATH_SUFFIX,
+                    "io.elementary.files.PluginStats",
+                    "GetReport",
+                    null,
+                    new VariantType ("(s)"),
+                    DBusCallFlags.NONE,
+                    -1
+                );
+
+                stdout.printf ("%s", reply.get_child_value (0).get_string ());
+            } catch (Error e) {
+                stderr.printf ("Error: failed to get plugin statistics: %s\n", e.message);
+                return Posix.EXIT_FAILURE;
+            }
+
+            return Posix.EXIT_SUCCESS;
+        }
+
         // Only handle --debug if not remote
         // FIXME: GLib.Environment.set_variable() is not thread-safe, use a custom GLib.LogFuncWriter for this
         if (!remote && "debug" in options) {
@@ -125,6 +155,25 @@ public class Files.Application : Gtk.Application {
         return -1;
     }
 
+    public override bool dbus_register (DBusConnection connection, string object_path) throws Error {
+        base.dbus_register (connection, object_path);
+        plugin_stats_id = connection.register_object (
+            object_path + PluginStatsService.OBJECT_PATH_SUFFIX,
+            new PluginStatsService ()
+        );
+
+        return true;
+    }
+
+    public override void dbus_unregister (DBusConnection connection, string object_path) {
+        if (plugin_stats_id > 0) {
+            connection.unregister_object (plugin_stats_id);
+            plugin_stats_id = 0;
+        }
+
+        base.dbus_unregister (connection, object_path);
+    }
+
     public override void startup () {
         base.startup ();
 
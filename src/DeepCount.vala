@@ -17,93 +17,98 @@
     Author: ammonkey <am.monkeyd@gmail.com>
 ***/
 
+/* Counts the files and folders below a folder and their size. Counts are shared with the other DeepCounts
+ * through DeepCountService, which also remembers what it counted.
+ */
 public class Files.DeepCount : Object {
+    private const uint PROGRESS_INTERVAL_MSEC = 250;
 
-    private GLib.File file;
-    private string deep_count_attrs;
-    private Cancellable cancellable;
-    private List<GLib.File>? directories = null;
+    private DeepCountService.Folder folder;
+    private uint progress_timeout_id = 0;
+    private bool counting = true;
+    private uint max_dirs;
 
     public int file_not_read = 0;
     public uint64 total_size = 0;
     public uint files_count = 0;
     public uint dirs_count = 0;
     public uint directories_count = 0;
+    /* Whether counting stopped early because more than the maximum number of folders were found */
+    public bool is_truncated = false;
 
     public signal void finished ();
-
-    public DeepCount (GLib.File _file) {
-        file = _file;
-        deep_count_attrs = string.join (",",
-                                        FileAttribute.STANDARD_NAME,
-                                        FileAttribute.STANDARD_TYPE,
-                                        FileAttribute.STANDARD_SIZE,
-                                        FileAttribute.STANDARD_ALLOCATED_SIZE);
-        cancellable = new Cancellable ();
-        process_directory.begin (file);
+    /* Emitted now and then while counting, with the totals so far */
+    public signal void progress ();
+
+    /* Counting stops once more than @_max_dirs folders are found, unless it is 0 */
+    public DeepCount (GLib.File _file, uint _max_dirs = 0) {
+        max_dirs = _max_dirs;
+        folder = DeepCountService.get_default ().get_folder (_file);
+        folder.hold ();
+        count.begin ();
     }
 
-    private Mutex mutex;
-
-    private async void process_directory (GLib.File directory) {
-        directories.prepend (directory);
-        try {
-            /*bool exists = yield Utils.query_exists_async (directory);
-              if (!exists) return;*/
-            var e = yield directory.enumerate_children_async (deep_count_attrs,
-                                                              FileQueryInfoFlags.NOFOLLOW_SYMLINKS,
-                                                              Priority.LOW, cancellable);
-
-            while (true) {
-                var files = yield e.next_files_async (1024, Priority.LOW, cancellable);
-                if (files == null) {
-                    break;
-                }
-
-                foreach (var f in files) {
-                    unowned string name = f.get_name ();
-                    GLib.File location = directory.get_child (name);
-                    if (f.get_file_type () == FileType.DIRECTORY) {
-                        yield process_directory (location);
-                        dirs_count++;
-                    } else {
-                        files_count++;
-                    }
-                    mutex.lock ();
-                    uint64 file_size = f.get_size ();
-                    uint64 allocated_size = f.get_attribute_uint64 (FileAttribute.STANDARD_ALLOCATED_SIZE);
-                    /* Check for sparse file, allocated size will be smaller, for normal files allocated size
-                     * includes overhead size so we don't use it for those here
-                     */
-                    /* Network files may not have allocated size attribute so ignore zero result */
-                    if (allocated_size > 0 &&
-                        allocated_size < file_size &&
-                        f.get_file_type () != FileType.DIRECTORY) {
-
-                        file_size = allocated_size;
-                    }
-
-                    total_size += file_size;
-                    mutex.unlock ();
-                }
-            }
-        } catch (Error err) {
-            if (!(err is IOError.CANCELLED)) {
-                mutex.lock ();
-                file_not_read ++;
-                mutex.unlock ();
-                debug ("%s", err.message);
-            }
+    private async void count () {
+        var handler = folder.progress.connect (on_folder_progress);
+        yield folder.count ();
+        folder.disconnect (handler);
+        if (!counting) {
+            return; // Cancelled
         }
 
-        directories.remove (directory);
+        counting = false;
+        cancel_progress ();
+        update_totals ();
+        folder.release ();
+        finished ();
+    }
 
-        if (directories == null) {
+    private void on_folder_progress () {
+        if (max_dirs > 0 && counting && folder.totals.dirs > max_dirs) {
+            counting = false;
+            is_truncated = true;
+            cancel_progress ();
+            update_totals ();
+            folder.release ();
             finished ();
+        } else {
+            schedule_progress ();
+        }
+    }
+
+    private void schedule_progress () {
+        if (progress_timeout_id == 0 && counting) {
+            progress_timeout_id = GLib.Timeout.add (PROGRESS_INTERVAL_MSEC, () => {
+                progress_timeout_id = 0;
+                update_totals ();
+                progress ();
+                return GLib.Source.REMOVE;
+            });
+        }
+    }
+
+    private void cancel_progress () {
+        if (progress_timeout_id > 0) {
+            GLib.Source.remove (progress_timeout_id);
+            progress_timeout_id = 0;
         }
     }
 
+    private void update_totals () {
+        total_size = folder.totals.size;
+        files_count = folder.totals.files;
+        dirs_count = folder.totals.dirs;
+        file_not_read = folder.totals.not_read;
+    }
+
+    /* Neither finished nor progress are emitted after cancelling */
     public void cancel () {
-        cancellable.cancel ();
+        if (!counting) {
+            return;
+        }
+
+        counting = false;
+        cancel_progress ();
+        folder.release ();
     }
 }
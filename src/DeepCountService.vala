@@ -0,0 +1,267 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* Counts the contents of folders for DeepCounts. What each folder directly contains is remembered together with the
+ * modification time of the folder, so counting a folder again only enumerates the folders changed since and otherwise
+ * queries one modification time per folder. A count of a folder is shared by every DeepCount of that folder or of a
+ * folder above it, and is only cancelled when none of them still needs it.
+ */
+public class Files.DeepCountService : GLib.Object {
+    /* What was counted in a folder and the folders below it */
+    public struct Totals {
+        public uint64 size;
+        public uint files;
+        public uint dirs;
+        public int not_read;
+
+        public void add (Totals other) {
+            size += other.size;
+            files += other.files;
+            dirs += other.dirs;
+            not_read += other.not_read;
+        }
+    }
+
+    public class Folder : GLib.Object {
+        private const string MTIME_ATTRIBUTES = FileAttribute.TIME_MODIFIED + "," + FileAttribute.TIME_MODIFIED_USEC;
+        private const string COUNT_ATTRIBUTES = FileAttribute.STANDARD_NAME + "," +
+                                                FileAttribute.STANDARD_TYPE + "," +
+                                                FileAttribute.STANDARD_SIZE + "," +
+                                                FileAttribute.STANDARD_ALLOCATED_SIZE;
+
+        public GLib.File location { get; construct; }
+        /* Complete once a count finishes without being cancelled, otherwise what has been counted so far */
+        public Totals totals;
+        public bool is_counting { get; private set; default = false; }
+        public bool is_complete { get; private set; default = false; }
+        public bool is_idle {
+            get {
+                return users == 0 && !is_counting;
+            }
+        }
+
+        /* Emitted whenever totals grow during a count */
+        public signal void progress ();
+        public signal void finished ();
+
+        /* What the folder directly contains, valid while the folder is listed and its modification time unchanged */
+        private bool is_listed = false;
+        private uint64 listed_mtime = 0;
+        private Totals own;
+        private string[] subfolders = {};
+
+        private uint users = 0;
+        private GLib.Cancellable? cancellable = null;
+        private Folder? counting_subfolder = null;
+
+        public Folder (GLib.File location) {
+            Object (location: location);
+        }
+
+        public void hold () {
+            users++;
+        }
+
+        /* Cancels the count, and that of the subfolder being counted, once nothing holds the folder */
+        public void release () {
+            if (users == 0 || --users > 0) {
+                return;
+            }
+
+            if (cancellable != null) {
+                cancellable.cancel ();
+            }
+
+            if (counting_subfolder != null) {
+                Folder subfolder = (owned) counting_subfolder;
+                subfolder.release ();
+            }
+        }
+
+        /* The folder is listed again by the next count even if its modification time is unchanged */
+        public void forget () {
+            is_listed = false;
+        }
+
+        /* Counts the folder, or waits for a count already running, and returns when the count finishes */
+        public async void count () {
+            while (is_counting) {
+                var handler = finished.connect (() => {
+                    GLib.Idle.add (count.callback);
+                });
+
+                yield;
+                disconnect (handler);
+                if (is_complete) {
+                    return;
+                }
+            }
+
+            is_counting = true;
+            is_complete = false;
+            totals = Totals ();
+            var count_cancellable = new GLib.Cancellable ();
+            cancellable = count_cancellable;
+
+            yield list (count_cancellable);
+            var counted = own;
+            totals = counted;
+            progress ();
+
+            unowned var names = subfolders;
+            foreach (unowned var name in names) {
+                if (count_cancellable.is_cancelled ()) {
+                    break;
+                }
+
+                var subfolder = DeepCountService.get_default ().get_folder (location.get_child (name));
+                subfolder.hold ();
+                counting_subfolder = subfolder;
+                var handler = subfolder.progress.connect (() => {
+                    totals = counted;
+                    totals.add (subfolder.totals);
+                    progress ();
+                });
+
+                yield subfolder.count ();
+                subfolder.disconnect (handler);
+                counted.add (subfolder.totals);
+                totals = counted;
+                if (counting_subfolder != null) {
+                    counting_subfolder = null;
+                    subfolder.release ();
+                }
+
+                progress ();
+            }
+
+            is_complete = !count_cancellable.is_cancelled ();
+            cancellable = null;
+            is_counting = false;
+            finished ();
+        }
+
+        /* Enumerates the folder unless it has not been modified since it was last listed */
+        private async void list (GLib.Cancellable count_cancellable) {
+            try {
+                var info = yield location.query_info_async (MTIME_ATTRIBUTES, FileQueryInfoFlags.NOFOLLOW_SYMLINKS,
+                                                            Priority.LOW, count_cancellable);
+
+                /* Remote folders may have no modification time so are always listed */
+                uint64 mtime = 0;
+                if (info.has_attribute (FileAttribute.TIME_MODIFIED)) {
+                    mtime = info.get_attribute_uint64 (FileAttribute.TIME_MODIFIED) * 1000000 +
+                            info.get_attribute_uint32 (FileAttribute.TIME_MODIFIED_USEC);
+                }
+
+                if (is_listed && mtime > 0 && mtime == listed_mtime) {
+                    return;
+                }
+
+                is_listed = false;
+                Totals new_own = {};
+                string[] new_subfolders = {};
+                var e = yield location.enumerate_children_async (COUNT_ATTRIBUTES,
+                                                                 FileQueryInfoFlags.NOFOLLOW_SYMLINKS,
+                                                                 Priority.LOW, count_cancellable);
+
+                while (true) {
+                    var infos = yield e.next_files_async (1024, Priority.LOW, count_cancellable);
+                    if (infos == null) {
+                        break;
+                    }
+
+                    foreach (var f in infos) {
+                        var is_dir = f.get_file_type () == FileType.DIRECTORY;
+                        if (is_dir) {
+                            new_subfolders += f.get_name ();
+                            new_own.dirs++;
+                        } else {
+                            new_own.files++;
+                        }
+
+                        uint64 file_size = f.get_size ();
+                        uint64 allocated_size = f.get_attribute_uint64 (FileAttribute.STANDARD_ALLOCATED_SIZE);
+                        /* Check for sparse file, allocated size will be smaller, for normal files allocated size
+                         * includes overhead size so we don't use it for those here
+                         */
+                        /* Network files may not have allocated size attribute so ignore zero result */
+                        if (allocated_size > 0 && allocated_size < file_size && !is_dir) {
+                            file_size = allocated_size;
+                        }
+
+                        new_own.size += file_size;
+                    }
+                }
+
+                own = new_own;
+                subfolders = (owned) new_subfolders;
+                listed_mtime = mtime;
+                is_listed = true;
+            } catch (Error err) {
+                own = Totals ();
+                subfolders = {};
+                if (!(err is IOError.CANCELLED)) {
+                    own.not_read = 1;
+                    debug ("%s", err.message);
+                }
+            }
+        }
+    }
+
+    /* Folders no longer in use are forgotten when more than this number are remembered */
+    private const uint MAX_FOLDERS = 65536;
+
+    private static DeepCountService? instance = null;
+
+    public static unowned DeepCountService get_default () {
+        if (instance == null) {
+            instance = new DeepCountService ();
+        }
+
+        return instance;
+    }
+
+    private GLib.HashTable<GLib.File, Folder> folders;
+    private uint trim_size = MAX_FOLDERS;
+
+    construct {
+        folders = new GLib.HashTable<GLib.File, Folder> (GLib.File.hash, GLib.File.equal);
+    }
+
+    public Folder get_folder (GLib.File location) {
+        var folder = folders.lookup (location);
+        if (folder == null) {
+            if (folders.size () >= trim_size) {
+                trim ();
+            }
+
+            folder = new Folder (location);
+            folders.insert (location, folder);
+        }
+
+        return folder;
+    }
+
+    /* @location is listed again by the next count of it, e.g. because a file in it changed size */
+    public void forget (GLib.File location) {
+        var folder = folders.lookup (location);
+        if (folder != null) {
+            folder.forget ();
+        }
+    }
+
+    public void forget_all () {
+        folders.foreach ((location, folder) => {
+            folder.forget ();
+        });
+    }
+
+    private void trim () {
+        folders.foreach_remove ((location, folder) => folder.is_idle);
+        /* Avoid trimming on every new folder if most folders are being counted */
+        trim_size = uint.max (MAX_FOLDERS, folders.size () * 2);
+    }
+}
@@ -61,6 +61,9 @@ public class Files.View.PropertiesWindow : AbstractPropertiesDialog {
 
     private Mutex mutex;
     private GLib.List<DeepCount>? deep_count_directories = null;
+    private GLib.List<RecursiveMonitor>? folder_monitors = null;
+    private bool recount_needed = false;
+    private ulong uncounted_folders_handler = 0;
 
     private Gee.Set<string>? mimes;
     private Gtk.Label resolution_value;
@@ -132,6 +135,13 @@ public class Files.View.PropertiesWindow : AbstractPropertiesDialog {
             foreach (var dir in deep_count_directories) {
                 dir.cancel ();
             }
+
+            foreach (var monitor in folder_monitors) {
+                monitor.changed.disconnect (on_folder_contents_changed);
+                monitor.release ();
+            }
+
+            folder_monitors = null;
         });
 
         /* The properties window may outlive the passed-in file object
@@ -190,6 +200,10 @@ public class Files.View.PropertiesWindow : AbstractPropertiesDialog {
                 pixel_size = 48
             };
             overlay_emblems (file_icon, goffile.emblems_list);
+
+            if (only_one && PreviewEngine.can_preview (goffile)) {
+                load_preview.begin (file_icon);
+            }
         }
 
         /* Build header box */
@@ -297,6 +311,8 @@ public class Files.View.PropertiesWindow : AbstractPropertiesDialog {
         size_warning = 0;
 
         deep_count_directories = null;
+        /* Folders are watched so that their sizes are recounted when their contents change */
+        var watch_folders = folder_monitors == null;
 
         foreach (Files.File gof in files) {
             if (gof.is_root_network_folder ()) {
@@ -309,11 +325,21 @@ public class Files.View.PropertiesWindow : AbstractPropertiesDialog {
                 mutex.unlock ();
 
                 selected_folders++;
+                if (watch_folders) {
+                    var monitor = RecursiveMonitor.get_for_root (gof.location);
+                    if (monitor != null) {
+                        monitor.changed.connect (on_folder_contents_changed);
+                        folder_monitors.prepend (monitor);
+                    }
+                }
+
                 var d = new DeepCount (gof.location); /* Starts counting on creation */
                 deep_count_directories.prepend (d);
 
+                d.progress.connect (show_partial_size);
                 d.finished.connect (() => {
                     mutex.lock ();
+                    d.progress.disconnect (show_partial_size);
                     deep_count_directories.remove (d);
 
                     total_size += d.total_size;
@@ -339,18 +365,61 @@ public class Files.View.PropertiesWindow : AbstractPropertiesDialog {
 
         if (uncounted_folders > 0) {/* possible race condition - uncounted_folders could have been decremented? */
             spinner.start ();
-            uncounted_folders_changed.connect (() => {
-                if (uncounted_folders == 0) {
-                    spinner.hide ();
-                    spinner.stop ();
-                    update_size_value ();
-                }
-            });
+            if (uncounted_folders_handler == 0) {
+                uncounted_folders_handler = uncounted_folders_changed.connect (() => {
+                    if (uncounted_folders == 0) {
+                        spinner.hide ();
+                        spinner.stop ();
+                        update_size_value ();
+                        if (recount_needed) {
+                            recount_needed = false;
+                            update_selection_size ();
+                        }
+                    }
+                });
+            }
         } else {
             update_size_value ();
         }
     }
 
+    /* The size of the selected files and counted folders plus what has been counted so far in the others */
+    private void show_partial_size () {
+        var size = total_size;
+        foreach (unowned var d in deep_count_directories) {
+            size += d.total_size;
+        }
+
+        size_value.label = format_size (size);
+    }
+
+    private void on_folder_contents_changed (RecursiveMonitor.ChangeSet changes) {
+        /* Files may change size without their folder being modified so the shared counts must list them again */
+        if (changes.overflow) {
+            DeepCountService.get_default ().forget_all ();
+        } else {
+            forget_parents (changes.created);
+            forget_parents (changes.deleted);
+            forget_parents (changes.changed);
+        }
+
+        /* Counts still running are repeated when they finish */
+        if (uncounted_folders > 0) {
+            recount_needed = true;
+        } else {
+            update_selection_size ();
+        }
+    }
+
+    private void forget_parents (GLib.GenericSet<GLib.File> files) {
+        files.foreach ((file) => {
+            var parent = file.get_parent ();
+            if (parent != null) {
+                DeepCountService.get_default ().forget (parent);
+            }
+        });
+    }
+
     private void rename_file (Files.File file, string _new_name) {
         /* Only rename if name actually changed */
         original_name = file.info.get_name ();
@@ -514,6 +583,14 @@ public class Files.View.PropertiesWindow : AbstractPropertiesDialog {
         return _("Unknown");
     }
 
+    private async void load_preview (Gtk.Image file_icon) {
+        var scale = get_scale_factor ();
+        var pix = yield PreviewEngine.get_default ().get_preview (goffile, 48, scale, 0, cancellable);
+        if (pix != null && !cancellable.is_cancelled ()) {
+            file_icon.set_from_surface (Gdk.cairo_surface_create_from_pixbuf (pix, scale, null));
+        }
+    }
+
     private async void get_resolution (Files.File goffile) {
         GLib.FileInputStream? stream = null;
         GLib.File file = goffile.location;
@@ -0,0 +1,25 @@
+/*
+ * SPDX-FileCopyrightText: 2025 elementary, Inc. (https://elementary.io)
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+/* Exposes how long each plugin has been taking in a running instance, e.g. for `io.elementary.files --plugin-stats` */
+[DBus (name = "io.elementary.files.PluginStats")]
+public class Files.PluginStatsService : GLib.Object {
+    public const string OBJECT_PATH_SUFFIX = "/PluginStats";
+
+    /* One line per plugin hook that has been called */
+    public string get_report () throws GLib.DBusError, GLib.IOError {
+        return plugins != null ? plugins.get_stats_report () : "";
+    }
+
+    /* a(sa{s(ttxxat)}): for each plugin, the calls, items, total and maximum microseconds and latency histogram of
+     * each of its hooks */
+    public GLib.Variant get_stats () throws GLib.DBusError, GLib.IOError {
+        if (plugins == null) {
+            return new GLib.Variant.array (new GLib.VariantType ("(sa{s(ttxxat)})"), new GLib.Variant[0]);
+        }
+
+        return plugins.get_stats ();
+    }
+}
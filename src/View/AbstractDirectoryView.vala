@@ -184,6 +184,16 @@ namespace Files {
         /* Support for keeping cursor position after delete */
         private Gtk.TreePath deleted_path;
 
+        /* Support for adding loaded files to the model in slices so that frames are not delayed */
+        private const int64 POPULATE_BUDGET_USEC = 4000;
+        private Gee.LinkedList<Files.File> files_to_add = new Gee.LinkedList<Files.File> ();
+        /* The directory of each file in files_to_add that is still to be added, which may be an expanded subfolder.
+         * Deleted files are dropped from here in constant time. */
+        private Gee.HashMap<Files.File, Directory> files_to_add_dirs = new Gee.HashMap<Files.File, Directory> ();
+        private uint populate_idle_id = 0;
+        /* Directories done loading whose files are still queued */
+        private Gee.ArrayList<Directory> dirs_done_loading = new Gee.ArrayList<Directory> ();
+
         /* UI options for button press handling */
         protected bool right_margin_unselects_all = false;
         protected bool on_directory = false;
@@ -211,6 +221,8 @@ namespace Files {
             count of the file object.*/
         protected GLib.List<Files.File> selected_files = null;
         private bool selected_files_invalid = true;
+        /* The same files as selected_files with running totals, kept up to date by update_selected_files_and_menu () */
+        private Files.SelectionSet selection = new Files.SelectionSet (PropertiesWindow.file_real_size);
 
         private GLib.AppInfo default_app;
         private Gtk.TreePath? hover_path = null;
@@ -267,7 +279,7 @@ namespace Files {
         private Gtk.Button hidden_button;
         private Gtk.Overlay overlay;
         private unowned ClipboardManager clipboard;
-        protected Files.ListModel model;
+        protected Files.DirectoryModel model;
         protected Files.IconRenderer icon_renderer;
         protected unowned View.Slot slot; // Must be unowned else cyclic reference stops destruction
         protected unowned View.Window? window {
@@ -366,7 +378,7 @@ namespace Files {
                 draw_when_idle ();
             });
 
-            model = new Files.ListModel ();
+            model = create_model ();
 
              /* Currently, "single-click rename" is disabled, matching existing UI
               * Currently, "right margin unselects all" is disabled, matching existing UI
@@ -633,6 +645,39 @@ namespace Files {
             return selected_files;
         }
 
+        public unowned Files.SelectionSet get_selection () {
+            update_selected_files_and_menu ();
+            return selection;
+        }
+
+        /* The top level file at the cursor, if any, followed by up to @n_neighbours files on either side */
+        public GLib.List<Files.File> get_files_around_cursor (int n_neighbours) {
+            var files = new GLib.List<Files.File> ();
+            var path = get_path_at_cursor ();
+            if (path == null) {
+                return files;
+            }
+
+            var cursor_row = path.get_indices ()[0];
+            var n_rows = (int) model.get_length ();
+            for (int row = cursor_row - n_neighbours; row <= cursor_row + n_neighbours; row++) {
+                if (row < 0 || row >= n_rows) {
+                    continue;
+                }
+
+                var file = model.file_for_path (new Gtk.TreePath.from_indices (row));
+                if (file == null) {
+                    continue;
+                } else if (row == cursor_row) {
+                    files.prepend (file);
+                } else {
+                    files.append (file);
+                }
+            }
+
+            return files;
+        }
+
 /*** Protected Methods */
         protected void set_active_slot (bool scroll = true) {
             slot.active (scroll);
@@ -771,6 +816,7 @@ namespace Files {
             /* after calling this (prior to reloading), the directory must be re-initialised so
              * we reconnect the file_loaded and done_loading signals */
             freeze_tree ();
+            cancel_population ();
             block_model ();
             model.clear ();
             all_selected = false;
@@ -1368,10 +1414,72 @@ namespace Files {
 
         private void on_directory_file_loaded (Directory dir, Files.File file) {
             // Do not select or sort files added during initial load.
-            model.add_file (file, dir);
+            files_to_add.offer_tail (file);
+            files_to_add_dirs[file] = dir;
+            if (populate_idle_id == 0 && !defer_loading_rows ()) {
+                /* Runs after each batch of loaded files, at a lower priority than redrawing */
+                populate_idle_id = Idle.add (populate_model);
+            }
+        }
+
+        /* Adds queued files to the model for up to POPULATE_BUDGET_USEC per call, so the first rows are shown as soon
+         * as they are loaded and each frame is delayed by a bounded time however large the folder. */
+        private bool populate_model () {
+            var deadline = GLib.get_monotonic_time () + POPULATE_BUDGET_USEC;
+            while (!files_to_add.is_empty && GLib.get_monotonic_time () < deadline && !defer_loading_rows ()) {
+                add_next_loading_file ();
+            }
+
             if (no_files_label.visible || hidden_label.visible) {
                 update_no_files_labels ();
             }
+
+            show_loading_rows ();
+            if (!files_to_add.is_empty && !defer_loading_rows ()) {
+                return Source.CONTINUE;
+            }
+
+            populate_idle_id = 0;
+            if (!dirs_done_loading.is_empty) {
+                finish_population ();
+            }
+
+            return Source.REMOVE;
+        }
+
+        /* Adds the files left when rows are no longer added while loading, then finishes loading each directory
+         * that is done loading */
+        private void finish_population () {
+            if (!files_to_add.is_empty) {
+                /* Added at once with the rows hidden, as the view would be laid out again for each row */
+                hide_loading_rows ();
+                while (!files_to_add.is_empty) {
+                    add_next_loading_file ();
+                }
+
+                show_loading_rows ();
+            }
+
+            var dirs = dirs_done_loading;
+            dirs_done_loading = new Gee.ArrayList<Directory> ();
+            foreach (var dir in dirs) {
+                finish_loading (dir);
+            }
+        }
+
+        private void add_next_loading_file () {
+            var file = files_to_add.poll_head ();
+            Directory dir;
+            if (files_to_add_dirs.unset (file, out dir)) {
+                model.add_file (file, dir);
+            } // Else deleted while waiting to be added
+        }
+
+        private void cancel_population () {
+            cancel_timeout (ref populate_idle_id);
+            files_to_add.clear ();
+            files_to_add_dirs.clear ();
+            dirs_done_loading.clear ();
         }
 
         private void on_directory_file_changed (Directory dir, Files.File file) {
@@ -1379,6 +1487,8 @@ namespace Files {
                 /* The slot directory has changed - it can only be the properties */
                 is_writable = slot.directory.file.is_writable ();
             } else {
+                /* Rewriting a file does not change the modification time of its folder */
+                DeepCountService.get_default ().forget (dir.location);
                 on_directory_file_icon_changed (dir, file);
             }
         }
@@ -1405,6 +1515,8 @@ namespace Files {
             /* The deleted file could be the whole directory, which is not in the model but that
              * that does not matter.  */
             file.exists = false;
+            files_to_add_dirs.unset (file);
+
             model.remove_file (file, dir);
 
             update_no_files_labels ();
@@ -1427,6 +1539,14 @@ namespace Files {
 
         private void on_directory_done_loading (Directory dir) {
             /* Should only be called on directory creation or reload */
+            dirs_done_loading.add (dir);
+            if (populate_idle_id == 0 || defer_loading_rows ()) {
+                cancel_timeout (ref populate_idle_id);
+                finish_population ();
+            } // Else sorted and thawed by populate_model () once every loaded file is in the model
+        }
+
+        private void finish_loading (Directory dir) {
             disconnect_directory_loading_handlers (dir);
             in_trash = slot.directory.is_trash;
             in_recent = slot.directory.is_recent;
@@ -2308,7 +2428,7 @@ namespace Files {
             if (!in_trash) {
                 // We send the actual files - it is up to the plugin to extract target
                 // if needed.  Color tag plugin needs actual file, others need target
-                plugins.hook_context_menu (menu, get_selected_files ());
+                plugins.hook_context_menu (menu, get_selected_files (), get_selection ());
 
                 if (selection.length () == 1 && "image" in selection.nth_data (0).info.get_content_type ()) {
                     var wallpaper_menuitem = new Gtk.MenuItem.with_label (_("Set as Wallpaper")) {
@@ -2778,6 +2898,7 @@ namespace Files {
                 bool valid_iter;
                 Files.File? file;
                 GLib.List<Files.File> visible_files = null;
+                GLib.List<Files.File> plugin_files = null;
                 uint actually_visible = 0;
                 if (get_visible_range (out start_path, out end_path)) {
                     sp = start_path;
@@ -2803,9 +2924,14 @@ namespace Files {
                         file = model.file_for_iter (iter); // Maybe null if dummy row or file being deleted
                         path = model.get_path (iter);
                         if (file != null) {
-                            update_icon_and_plugins (file);
+                            if (!file.is_gone) {
+                                update_shown_icon (file);
+                                plugin_files.prepend (file);
+                            }
+
                             /* Ask thumbnailer only if ThumbState UNKNOWN */
                             if (should_thumbnail) {
+                                request_preview (file);
                                 if (file.thumbstate == Files.File.ThumbState.UNKNOWN) {
                                     visible_files.prepend (file);
                                     if (path.compare (sp) >= 0 && path.compare (ep) <= 0) {
@@ -2825,6 +2951,12 @@ namespace Files {
                     }
                 }
 
+                /* Plugins are given the files shown in one batch */
+                if (plugins != null && plugin_files != null) {
+                    plugin_files.reverse ();
+                    plugins.update_files_info (plugin_files);
+                }
+
                 /* This is the only place that new thumbnail files are created */
                 /* Do not trigger a thumbnail request unless:
                     * there are unthumbnailed files actually visible
@@ -2844,14 +2976,11 @@ namespace Files {
             });
         }
 
-        // Called on individual files when added or changed as well as on all visible files
+        // Called on individual files when added or changed. The visible files are updated in one batch
         // by schedule_thumbnail_color_tag_timeout.
         private void update_icon_and_plugins (Files.File file) requires (file != null) {
             if (!file.is_gone) {
-                // Only update thumbnail if it is going to be shown
-                if (should_thumbnail) {
-                    file.update_icon ();
-                }
+                update_shown_icon (file);
 
                 /* In any case, ensure color-tag info is correct */
                 if (plugins != null) {
@@ -2859,6 +2988,35 @@ namespace Files {
                 }
             }
         }
+
+        private void update_shown_icon (Files.File file) {
+            // Only update thumbnail if it is going to be shown
+            if (should_thumbnail) {
+                file.update_icon (-1, -1, true);
+            }
+        }
+
+        /* Renders a preview in-process for a file the thumbnailer could not thumbnail, e.g. a PDF when no
+         * thumbnailer is installed. The file shows the preview once it is ready. */
+        private void request_preview (Files.File file) {
+            if (file.thumbstate != Files.File.ThumbState.NONE || !PreviewEngine.can_render_in_process (file)) {
+                return;
+            }
+
+            unowned var engine = PreviewEngine.get_default ();
+            var size = file.pix_size;
+            var scale = file.pix_scale;
+            if (engine.lookup (file, size, scale) != null) {
+                return;
+            }
+
+            engine.get_preview.begin (file, size, scale, 0, null, (obj, res) => {
+                if (engine.get_preview.end (res) != null && should_thumbnail) {
+                    file.update_icon (size, scale, true);
+                }
+            });
+        }
+
 /** HELPER AND CONVENIENCE FUNCTIONS */
         /** This helps ensure that file item updates are reflected on screen without too many redraws **/
         uint draw_timeout_id = 0;
@@ -3797,6 +3955,7 @@ namespace Files {
                 var selected_count = get_selected_files_from_model (out selected_files);
                 all_selected = selected_count == slot.displayed_files_count;
                 selected_files.reverse ();
+                selection.update (selected_files);
                 selected_files_invalid = false;
                 update_menu_actions ();
                 selection_changed (selected_files);
@@ -3805,6 +3964,11 @@ namespace Files {
             one_or_less = (selected_files == null || selected_files.next == null);
         }
 
+        /* Views that do not expand subfolders use the flat model, which scales to very large folders */
+        protected virtual Files.DirectoryModel create_model () {
+            return new Files.FlatListModel ();
+        }
+
         protected virtual bool expand_collapse (Gtk.TreePath? path) {
             return true;
         }
@@ -3836,6 +4000,7 @@ namespace Files {
         public void close () {
             is_frozen = true; /* stop signal handlers running during destruction */
             cancel ();
+            cancel_population ();
             unselect_all ();
         }
 
@@ -4036,6 +4201,13 @@ namespace Files {
                                                     bool scroll_to_top);
         protected abstract void freeze_tree ();
         protected abstract void thaw_tree ();
+        /* Called while the tree is frozen for loading, once the first files are in the model */
+        protected virtual void show_loading_rows () {}
+        /* Views that are slow to add rows to while shown return true once rows are shown during loading. The
+         * remaining files are then added when loading is done, between hide_loading_rows () and
+         * show_loading_rows (). */
+        protected virtual bool defer_loading_rows () { return false; }
+        protected virtual void hide_loading_rows () {}
         protected new abstract void freeze_child_notify ();
         protected new abstract void thaw_child_notify ();
         protected abstract void connect_tree_signals ();
@@ -234,7 +234,7 @@ namespace Files {
                         model.get_iter (out iter, path);
                         string? text = null;
                         model.@get (iter, ListModel.ColumnID.FILENAME, out text);
-                        name_renderer.set_up_layout (text, name_renderer.width);
+                        name_renderer.set_up_layout (text, name_renderer.width, false);
                         // Calculate where click will activate
                         var active_width = name_renderer.text_width + name_renderer.double_border_radius;
                         bool is_on_active;
@@ -30,6 +30,11 @@ public class Files.View.DetailsColumn : Gtk.Bin {
     }
 
     construct {
+        cancellable = new GLib.Cancellable ();
+        destroy.connect (() => {
+            cancellable.cancel ();
+        });
+
         var file_real_size = PropertiesWindow.file_real_size (file);
 
         var info_grid = new Gtk.Grid () {
@@ -66,40 +71,10 @@ public class Files.View.DetailsColumn : Gtk.Bin {
 
         // overwriting, yes, but easier on the boolean
         if (file.is_readable () && file_real_size <= MAX_PREVIEW_FILE_SIZE) {
-            var filename = file.location.get_path ();
-
             if (file.is_image ()) {
                 file_image.gicon = new FileIcon (file.location);
                 file_image.pixel_size = PREVIEW_SIZE;
 
-            // thanks to https://wiki.gnome.org/Projects/Vala/PopplerSample
-            } else if (file.is_pdf ()) {
-                try {
-                    var doc = new Poppler.Document.from_file (
-                        Filename.to_uri (filename), null
-                    );
-
-                    var page = doc.get_page (0); //TODO: multi-page?
-
-                    var surface = new Cairo.ImageSurface (
-                        Cairo.Format.ARGB32, PREVIEW_SIZE, PREVIEW_SIZE
-                    );
-
-                    var ctx = new Cairo.Context (surface);
-                    ctx.set_source_rgb (255, 255, 255);
-                    ctx.paint ();
-                    ctx.scale (0.5, 0.5); //TODO: I just eye-balled this
-                    page.render (ctx);
-                    ctx.restore ();
-
-                    var pdf_pix = Gdk.pixbuf_get_from_surface (
-                        surface, 0, 0, PREVIEW_SIZE, PREVIEW_SIZE
-                    );
-
-                    file_image.set_from_pixbuf (pdf_pix);
-                } catch (Error e) {
-                    warning ("Error: %s\n", e.message);
-                }
             } else if (file.is_text ()) {
                 try {
                     previewing_text = true;
@@ -115,6 +90,10 @@ public class Files.View.DetailsColumn : Gtk.Bin {
             }
         }
 
+        if (!file.is_image () && !previewing_text && PreviewEngine.can_preview (file)) {
+            load_preview.begin (file_image);
+        }
+
         var name_key_label = make_key_label (_("Name:"));
         var name_value = make_value_label (file.get_display_name ());
 
@@ -277,6 +256,14 @@ public class Files.View.DetailsColumn : Gtk.Bin {
         return file.content_type;
     }
 
+    private async void load_preview (Gtk.Image file_image) {
+        var scale = get_scale_factor ();
+        var pix = yield PreviewEngine.get_default ().get_preview (file, PREVIEW_SIZE, scale, 0, cancellable);
+        if (pix != null && !cancellable.is_cancelled ()) {
+            file_image.set_from_surface (Gdk.cairo_surface_create_from_pixbuf (pix, scale, null));
+        }
+    }
+
     private async void get_resolution (Files.File goffile) {
         GLib.FileInputStream? stream = null;
         var file = goffile.location;
@@ -178,7 +178,7 @@ public class Files.IconView : Files.AbstractDirectoryView {
                 string? text = null;
                 model.@get (iter, ListModel.ColumnID.FILENAME, out text);
 
-                text_renderer.set_up_layout (text, area.width);
+                text_renderer.set_up_layout (text, area.width, false);
 
                 var is_on_blank = (
                     x < rect.x ||
@@ -331,6 +331,32 @@ public class Files.IconView : Files.AbstractDirectoryView {
         }
     }
 
+    /* Show the first screenful of rows without waiting for the rest of the folder to load. GtkIconView checks all
+     * its items for each row inserted, so no more rows are added while they are shown until loading is done. */
+    protected override void show_loading_rows () {
+        if (tree_frozen && tree.get_model () == null && model.iter_n_children (null) >= get_screenful ()) {
+            tree.set_model (model);
+        }
+    }
+
+    protected override bool defer_loading_rows () {
+        return tree_frozen && tree.get_model () != null;
+    }
+
+    protected override void hide_loading_rows () {
+        if (tree_frozen) {
+            tree.set_model (null);
+        }
+    }
+
+    /* Roughly the number of items that fit in the view, assuming items are about as tall as they are wide */
+    private int get_screenful () {
+        var item_size = int.max (1, tree.item_width + tree.column_spacing);
+        var columns = int.max (1, get_allocated_width () / item_size);
+        var rows = get_allocated_height () / item_size + 1;
+        return columns * rows;
+    }
+
     // For scrolling
     protected override void freeze_child_notify () {
         tree.freeze_child_notify ();
@@ -33,6 +33,7 @@ namespace Files {
         private uint unload_file_timeout_id = 0;
         private GLib.List<Gtk.TreeRowReference> subdirectories_to_unload = null;
         private GLib.List<Directory> loaded_subdirectories = null;
+        private Files.ListModel list_model;
 
         public ListView (View.Slot _slot) {
             base (_slot);
@@ -45,7 +46,7 @@ namespace Files {
         private void connect_additional_signals () {
             tree.row_expanded.connect (on_row_expanded);
             tree.row_collapsed.connect (on_row_collapsed);
-            model.subdirectory_unloaded.connect (on_model_subdirectory_unloaded);
+            list_model.subdirectory_unloaded.connect (on_model_subdirectory_unloaded);
         }
 
         private void append_extra_tree_columns () {
@@ -138,7 +139,7 @@ namespace Files {
                 }
 
                 if (model.get_iter (out iter, path) && iter != null) {
-                        model.unload_subdirectory (iter);
+                        list_model.unload_subdirectory (iter);
                 } else {
                     warning ("Subdirectory to unload not found in model");
                 }
@@ -201,6 +202,11 @@ namespace Files {
             return base.on_view_key_press_event (keyval, keycode, state);
         }
 
+        protected override Files.DirectoryModel create_model () {
+            list_model = new Files.ListModel ();
+            return list_model;
+        }
+
         protected override Gtk.Widget? create_view () {
             model.has_child = true;
             base.create_view ();
@@ -221,7 +227,7 @@ namespace Files {
             /* If a new subdirectory is loaded, connect it, load it
              * and add it to the list of subdirectories */
             Files.Directory? dir = null;
-            if (model.get_subdirectory (path, out dir)) { // Returns true if dir non null
+            if (list_model.get_subdirectory (path, out dir)) { // Returns true if dir non null
                 connect_directory_handlers (dir);
                 dir.init ();
                 /* Maintain our own reference on dir, independent of the model */
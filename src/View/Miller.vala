@@ -20,6 +20,8 @@ namespace Files.View {
     public class Miller : Files.AbstractSlot {
         private const int END_GAP = 120; // Space for manually expanding last slot
         private const int ANIMATION_RATE_MSEC = 1000 / 60 ;
+        private const uint PREFETCH_DELAY_MSEC = 100;
+        private const int PREFETCH_NEIGHBOURS = 1;
         public unowned View.ViewContainer ctab { get; construct; }
 
         /* Need private copy of initial location as Miller
@@ -46,6 +48,11 @@ namespace Files.View {
 
         private View.DetailsColumn? details = null;
 
+        /* Local folders at and next to the cursor of the current column, loaded before they are opened so that the
+         * next column is already populated. Only these references keep unshown folders in the directory cache. */
+        private GLib.HashTable<GLib.File, Directory> prefetched;
+        private uint prefetch_timeout_id = 0;
+
         public override bool is_frozen {
             set {
                 if (current_slot != null) {
@@ -67,6 +74,7 @@ namespace Files.View {
         }
 
         construct {
+            prefetched = new GLib.HashTable<GLib.File, Directory> (GLib.File.hash, GLib.File.equal);
             var prefs = (Files.Preferences.get_default ());
             prefs.notify["show-hidden-files"].connect ((s, p) => {
                 show_hidden_files_changed (((Files.Preferences)s).show_hidden_files);
@@ -292,7 +300,6 @@ namespace Files.View {
                         var list = new List<GLib.File> ();
                         list.prepend (file);
                         last_slot.select_glib_files (list, file);
-                        Thread.usleep (100000);
                         add_location (file, last_slot);
 
                     }
@@ -492,6 +499,7 @@ namespace Files.View {
         private void on_slot_selection_changed (AbstractSlot source, GLib.List<Files.File> files) {
             if (source == current_slot) {
                 clear_file_details ();
+                schedule_prefetch ();
 
                 if (Files.Preferences.get_default ().show_file_preview &&
                     files.length () == 1) {
@@ -519,6 +527,69 @@ namespace Files.View {
 
 /** Helper functions */
 
+        private void schedule_prefetch () {
+            if (prefetch_timeout_id > 0) {
+                GLib.Source.remove (prefetch_timeout_id);
+            }
+
+            prefetch_timeout_id = GLib.Timeout.add (PREFETCH_DELAY_MSEC, () => {
+                prefetch_timeout_id = 0;
+                prefetch_around_cursor ();
+                return Source.REMOVE;
+            });
+        }
+
+        private void prefetch_around_cursor () {
+            var wanted = new GLib.HashTable<GLib.File, Directory> (GLib.File.hash, GLib.File.equal);
+            if (current_slot != null) {
+                var files = current_slot.get_directory_view ().get_files_around_cursor (PREFETCH_NEIGHBOURS);
+                foreach (unowned var file in files) {
+                    /* Loading remote folders may be slow or need mounting */
+                    if (!file.is_folder () || !file.location.is_native ()) {
+                        continue;
+                    }
+
+                    var dir = prefetched.lookup (file.location);
+                    if (dir == null) {
+                        dir = Directory.from_file (file);
+                        if (dir.state == Directory.State.NOT_LOADED) {
+                            dir.done_loading.connect (on_prefetch_done_loading);
+                            dir.init ();
+                        }
+                    }
+
+                    wanted.insert (file.location, dir);
+                }
+            }
+
+            /* Stop loading folders that are no longer near the cursor */
+            prefetched.@foreach ((loc, dir) => {
+                if (!(loc in wanted) && dir.is_loading () && !is_shown (dir)) {
+                    dir.cancel ();
+                }
+            });
+
+            prefetched = wanted;
+        }
+
+        private void on_prefetch_done_loading (Directory dir) {
+            dir.done_loading.disconnect (on_prefetch_done_loading);
+            /* Loading marks the folder as expanded, which should only show once it is opened */
+            if (!is_shown (dir)) {
+                dir.file.set_expanded (false);
+            }
+        }
+
+        private bool is_shown (Directory dir) {
+            foreach (unowned var slot in slot_list) {
+                if (slot.directory == dir) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
         private void schedule_scroll_to_slot (View.Slot slot, bool animate = true) {
             if (scroll_to_slot_timeout_id > 0) {
                 GLib.Source.remove (scroll_to_slot_timeout_id);
@@ -579,6 +650,10 @@ namespace Files.View {
             return ((View.Slot)(current_slot)).get_selected_files ();
         }
 
+        public override unowned Files.SelectionSet? get_selection () {
+            return ((View.Slot)(current_slot)).get_selection ();
+        }
+
         public override void set_active_state (bool set_active, bool animate = true) {
             if (set_active) {
                 current_slot.active (true, animate);
@@ -643,6 +718,12 @@ namespace Files.View {
             if (total_width_timeout_id > 0) {
                 GLib.Source.remove (total_width_timeout_id);
             }
+            if (prefetch_timeout_id > 0) {
+                GLib.Source.remove (prefetch_timeout_id);
+                prefetch_timeout_id = 0;
+            }
+
+            prefetched.remove_all ();
 
             truncate_list_after_slot (slot_list.first ().data);
         }
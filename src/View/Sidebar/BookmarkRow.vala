@@ -36,6 +36,8 @@ public class Sidebar.BookmarkRow : Gtk.ListBoxRow, SidebarItemInterface {
         {"text/plain", Gtk.TargetFlags.SAME_APP, Files.TargetType.BOOKMARK_ROW},
     };
     static Gdk.Atom text_data_atom = Gdk.Atom.intern_static_string ("text/plain");
+    /* The tooltip size of a larger tree is only a lower bound, so hovering never walks a whole disk */
+    private const uint MAX_TOOLTIP_COUNT_FOLDERS = 2000;
 
     /* Each row gets a unique id.  The methods relating to this are in the SidebarItemInterface */
     static construct {
@@ -86,6 +88,7 @@ public class Sidebar.BookmarkRow : Gtk.ListBoxRow, SidebarItemInterface {
     private string? drop_text = null;
     private bool drop_occurred = false;
     private bool valid = true; //Set to false if scheduled for removal
+    private Files.DeepCount? deep_count = null;
 
     public BookmarkRow (string _custom_name,
                         string uri,
@@ -187,6 +190,15 @@ public class Sidebar.BookmarkRow : Gtk.ListBoxRow, SidebarItemInterface {
         set_up_drag ();
         set_up_drop ();
 
+        if (!pinned) {
+            /* The size of a bookmarked folder is counted while its tooltip is shown */
+            query_tooltip.connect (on_query_tooltip);
+            leave_notify_event.connect (() => {
+                cancel_deep_count ();
+                return Gdk.EVENT_PROPAGATE;
+            });
+        }
+
         var open_action = new SimpleAction ("open", null);
         open_action.activate.connect (() => activated ());
 
@@ -242,9 +254,40 @@ public class Sidebar.BookmarkRow : Gtk.ListBoxRow, SidebarItemInterface {
         grab_focus ();
     }
 
+    private bool on_query_tooltip (int x, int y, bool keyboard_tooltip, Gtk.Tooltip tooltip) {
+        if (deep_count == null && target_file.is_folder () && target_file.location.get_path () != null) {
+            deep_count = new Files.DeepCount (target_file.location, MAX_TOOLTIP_COUNT_FOLDERS);
+            deep_count.progress.connect (update_size_tooltip);
+            deep_count.finished.connect (update_size_tooltip);
+        }
+
+        return false; // Show the tooltip text
+    }
+
+    private void update_size_tooltip () {
+        var size = format_size (deep_count.total_size);
+        set_tooltip_text ("%s\n%s".printf (
+            Files.FileUtils.sanitize_path (uri, null, false),
+            deep_count.is_truncated ? _("More than %s").printf (size) : size
+        ));
+
+        trigger_tooltip_query ();
+    }
+
+    /* Counts are shared and remembered so counting again on the next hover is cheap */
+    private void cancel_deep_count () {
+        if (deep_count != null) {
+            deep_count.progress.disconnect (update_size_tooltip);
+            deep_count.finished.disconnect (update_size_tooltip);
+            deep_count.cancel ();
+            deep_count = null;
+        }
+    }
+
     public void destroy_bookmark () {
         /* We destroy all bookmarks - even permanent ones when refreshing */
         valid = false;
+        cancel_deep_count ();
         item_map_lock.@lock ();
         item_id_map.unset (id);
         item_map_lock.unlock ();
@@ -272,8 +272,9 @@ namespace Files.View {
 
         public override void initialize_directory () {
             if (directory.is_loading ()) {
-                /* This can happen when restoring duplicate tabs */
-                debug ("Slot.initialize_directory () called when directory already loading - ignoring");
+                /* This can happen when restoring duplicate tabs or when the directory is being prefetched */
+                debug ("Slot.initialize_directory () called when directory already loading - showing files loaded so far");
+                directory.emit_loaded_files ();
                 return;
             }
             /* view and slot are unfrozen when done loading signal received */
@@ -311,6 +312,10 @@ namespace Files.View {
             }
         }
 
+        public override unowned Files.SelectionSet? get_selection () {
+            return dir_view != null ? dir_view.get_selection () : null;
+        }
+
         public override void select_glib_files (GLib.List<GLib.File> files, GLib.File? focus_location) {
             if (dir_view != null) {
                 dir_view.select_glib_files_when_thawed (files, focus_location);
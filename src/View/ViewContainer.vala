@@ -432,6 +432,7 @@ namespace Files.View {
 
                 /* Only record valid folders (will also log Zeitgeist event) */
                 browser.record_uri (directory.uri); /* will ignore null changes i.e reloading*/
+                ThumbnailPrefetcher.get_default ().add_visited_folder (directory.location);
 
                 /* Notify plugins */
                 /* infobars are added to the view, not the active slot */
@@ -595,7 +596,7 @@ namespace Files.View {
             AbstractSlot aslot,
             GLib.List<unowned Files.File> files
         ) {
-            overlay_statusbar.selection_changed (files, aslot is Miller);
+            overlay_statusbar.selection_changed (files, aslot is Miller, aslot.get_selection ());
         }
 
         private void on_button_pressed_event (int n_press, double x, double y) {
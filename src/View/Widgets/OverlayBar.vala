@@ -28,6 +28,7 @@ namespace Files.View {
         private uint64 files_size = 0;
         private Files.File? goffile = null;
         private GLib.List<unowned Files.File>? selected_files = null;
+        private Files.SelectionSet? selection = null;
         private uint8 [] buffer;
         private uint update_timeout_id = 0;
         private DeepCount? deep_counter = null;
@@ -48,7 +49,9 @@ namespace Files.View {
             cancel ();
         }
 
-        public void selection_changed (GLib.List<unowned Files.File> files, bool is_miller) {
+        /* The totals of @selection, if given, are used for multiple files instead of counting them again */
+        public void selection_changed (GLib.List<unowned Files.File> files, bool is_miller,
+                                       Files.SelectionSet? selection = null) {
             cancel ();
             visible = false;
 
@@ -63,8 +66,9 @@ namespace Files.View {
                     selected_files = null;
                 }
 
+                this.selection = selection;
                 if (is_miller && Preferences.get_default ().show_file_preview &&
-                    files.length () == 1 && !files.data.is_folder ()) {
+                    files != null && files.next == null && !files.data.is_folder ()) {
 
                     visible = false;
                 } else {
@@ -78,6 +82,7 @@ namespace Files.View {
 
         public void reset_selection () {
             selected_files = null;
+            selection = null;
         }
 
         /**
@@ -123,6 +128,10 @@ namespace Files.View {
                     if (files.next == null) {
                         /* List contains only one element. */
                         goffile = files.first ().data;
+                    } else if (selection != null && selection.count > 1) {
+                        folders_count = selection.folders_count;
+                        files_count = selection.files_count;
+                        files_size = selection.total_size;
                     } else {
                         scan_list (files);
                     }
@@ -202,12 +211,14 @@ namespace Files.View {
 
             deep_count_timeout_id = GLib.Timeout.add_full (GLib.Priority.LOW, 1000, () => {
                 deep_counter = new DeepCount (goffile.location);
+                deep_counter.progress.connect (update_deep_count_label);
                 deep_counter.finished.connect (update_status_after_deep_count);
 
                 cancel_cancellable ();
                 cancellable = new Cancellable ();
                 cancellable.cancelled.connect (() => {
                     if (deep_counter != null) {
+                        deep_counter.progress.disconnect (update_deep_count_label);
                         deep_counter.finished.disconnect (update_status_after_deep_count);
                         deep_counter.cancel ();
                         deep_counter = null;
@@ -223,10 +234,14 @@ namespace Files.View {
         }
 
         private void update_status_after_deep_count () {
-            string str;
             cancellable = null;
             active = false;
+            update_deep_count_label ();
+        }
 
+        /* Also shows the totals so far while the spinner is active */
+        private void update_deep_count_label () {
+            string str;
             label = "%s - %s (".printf (goffile.info.get_name (), goffile.formated_type);
 
             if (deep_counter != null) {